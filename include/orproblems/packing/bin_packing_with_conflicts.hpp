@@ -20,6 +20,8 @@
 #include "optimizationtools/containers/indexed_set.hpp"
 #include "optimizationtools/utils/utils.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -31,6 +33,7 @@ namespace bin_packing_with_conflicts
 
 using ItemId = int64_t;
 using Weight = int64_t;
+using ItemPos = int64_t;
 using BinId = int64_t;
 
 /**
@@ -40,9 +43,25 @@ struct Item
 {
     /** Weight of the item. */
     Weight weight;
+};
+
+/**
+ * Structure for the neighbors of an item in the conflict graph.
+ */
+struct Neighbors
+{
+    /** Pointer to the first neighbor. */
+    const ItemId* first;
+
+    /** Pointer past the last neighbor. */
+    const ItemId* last;
+
+    const ItemId* begin() const { return first; }
+
+    const ItemId* end() const { return last; }
 
-    /** Conflicting items. */
-    std::vector<ItemId> neighbors;
+    /** Get the number of neighbors. */
+    ItemPos size() const { return last - first; }
 };
 
 /**
@@ -66,6 +85,51 @@ public:
     /** Get the capacity of the bins. */
     Weight capacity() const { return capacity_; }
 
+    /** Get the number of conflicts. */
+    ItemPos number_of_conflicts() const { return number_of_conflicts_; }
+
+    /** Get the neighbors of an item in the conflict graph, sorted by id. */
+    inline Neighbors neighbors(ItemId item_id) const
+    {
+        return {
+            neighbors_.data() + neighbors_offsets_[item_id],
+            neighbors_.data() + neighbors_offsets_[item_id + 1]};
+    }
+
+    /** Return 'true' iff the conflict graph is also stored as an adjacency bitset. */
+    inline bool has_conflict_bitset() const { return !conflict_bitset_.empty(); }
+
+    /** Get the number of 64-bit words of a row of the adjacency bitset. */
+    inline ItemPos number_of_bitset_words() const { return (number_of_items() + 63) / 64; }
+
+    /**
+     * Get the row of an item in the adjacency bitset.
+     *
+     * The adjacency bitset must be stored.
+     */
+    inline const uint64_t* conflict_bitset_row(ItemId item_id) const
+    {
+        return conflict_bitset_.data() + item_id * number_of_bitset_words();
+    }
+
+    /**
+     * Return 'true' iff two items are in conflict.
+     *
+     * It runs in O(1) if the adjacency bitset is stored and in
+     * O(log(number of neighbors)) otherwise.
+     */
+    inline bool conflict(
+            ItemId item_id_1,
+            ItemId item_id_2) const
+    {
+        if (has_conflict_bitset())
+            return (conflict_bitset_row(item_id_1)[item_id_2 / 64] >> (item_id_2 % 64)) & 1;
+        return std::binary_search(
+                neighbors_.begin() + neighbors_offsets_[item_id_1],
+                neighbors_.begin() + neighbors_offsets_[item_id_1 + 1],
+                item_id_2);
+    }
+
     /*
      * Outputs
      */
@@ -96,7 +160,7 @@ public:
                 os
                     << std::setw(12) << item_id
                     << std::setw(12) << item.weight
-                    << std::setw(12) << item.neighbors.size()
+                    << std::setw(12) << neighbors(item_id).size()
                     << std::endl;
             }
         }
@@ -111,7 +175,7 @@ public:
                 << std::setw(12) << "------"
                 << std::endl;
             for (ItemId item_id = 0; item_id < number_of_items(); ++item_id) {
-                for (ItemId item_id_neighbor: item(item_id).neighbors) {
+                for (ItemId item_id_neighbor: neighbors(item_id)) {
                     os
                         << std::setw(12) << item_id
                         << std::setw(12) << item_id_neighbor
@@ -167,7 +231,7 @@ public:
                 const Item& item = this->item(item_id);
 
                 // Check conflicts.
-                for (ItemId item_id_neighbor: item.neighbors) {
+                for (ItemId item_id_neighbor: neighbors(item_id)) {
                     if (current_bin_items.contains(item_id_neighbor)) {
                         number_of_conflict_violations++;
                         if (verbosity_level >= 2) {
@@ -250,6 +314,22 @@ private:
     /** Capacity of the bins. */
     Weight capacity_;
 
+    /*
+     * Computed attributes
+     */
+
+    /** Number of conflicts. */
+    ItemPos number_of_conflicts_ = 0;
+
+    /** Offsets of the neighbors of each item in 'neighbors_'. */
+    std::vector<ItemPos> neighbors_offsets_;
+
+    /** Neighbors of the items, sorted and without duplicates. */
+    std::vector<ItemId> neighbors_;
+
+    /** Adjacency bitset of the conflict graph; empty if not stored. */
+    std::vector<uint64_t> conflict_bitset_;
+
     friend class InstanceBuilder;
 };
 
@@ -280,13 +360,28 @@ public:
         instance_.items_[item_id].weight = weight;
     }
 
-    /** Add a conflict. */
+    /**
+     * Add a conflict.
+     *
+     * Duplicate conflicts are removed when building the instance.
+     */
     void add_conflict(
             ItemId item_id_1,
             ItemId item_id_2)
     {
-        instance_.items_[item_id_1].neighbors.push_back(item_id_2);
-        instance_.items_[item_id_2].neighbors.push_back(item_id_1);
+        conflicts_.push_back({item_id_1, item_id_2});
+    }
+
+    /**
+     * Set the density of the conflict graph above which it is also stored as
+     * an adjacency bitset.
+     *
+     * With the default value, the bitset is stored when it is smaller than
+     * the adjacency lists.
+     */
+    void set_conflict_bitset_density_threshold(double conflict_bitset_density_threshold)
+    {
+        conflict_bitset_density_threshold_ = conflict_bitset_density_threshold;
     }
 
     /** Build an instance from a file. */
@@ -316,6 +411,8 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        compute_conflict_graph();
+
         return std::move(instance_);
     }
 
@@ -325,6 +422,71 @@ private:
      * Private methods
      */
 
+    /**
+     * Compute the adjacency lists of the conflict graph, and its adjacency
+     * bitset if it is dense enough.
+     */
+    void compute_conflict_graph()
+    {
+        ItemId number_of_items = instance_.number_of_items();
+
+        // Build the adjacency lists in a single array.
+        std::vector<ItemPos>& offsets = instance_.neighbors_offsets_;
+        std::vector<ItemId>& neighbors = instance_.neighbors_;
+        offsets.assign(number_of_items + 1, 0);
+        for (const auto& conflict: conflicts_) {
+            offsets[conflict.first + 1]++;
+            if (conflict.second != conflict.first)
+                offsets[conflict.second + 1]++;
+        }
+        for (ItemId item_id = 0; item_id < number_of_items; ++item_id)
+            offsets[item_id + 1] += offsets[item_id];
+        neighbors.resize(offsets[number_of_items]);
+        std::vector<ItemPos> positions(offsets.begin(), offsets.end() - 1);
+        for (const auto& conflict: conflicts_) {
+            neighbors[positions[conflict.first]++] = conflict.second;
+            if (conflict.second != conflict.first)
+                neighbors[positions[conflict.second]++] = conflict.first;
+        }
+
+        // Sort the adjacency lists and remove duplicates.
+        ItemPos pos_new = 0;
+        ItemPos number_of_self_conflicts = 0;
+        for (ItemId item_id = 0; item_id < number_of_items; ++item_id) {
+            auto first = neighbors.begin() + offsets[item_id];
+            auto last = neighbors.begin() + offsets[item_id + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+            offsets[item_id] = pos_new;
+            for (auto it = first; it != last; ++it) {
+                if (*it == item_id)
+                    number_of_self_conflicts++;
+                neighbors[pos_new++] = *it;
+            }
+        }
+        offsets[number_of_items] = pos_new;
+        neighbors.resize(pos_new);
+        neighbors.shrink_to_fit();
+        instance_.number_of_conflicts_
+            = (pos_new - number_of_self_conflicts) / 2
+            + number_of_self_conflicts;
+
+        // Build the adjacency bitset.
+        instance_.conflict_bitset_.clear();
+        double density = (number_of_items <= 1)? 0:
+            (double)pos_new / number_of_items / (number_of_items - 1);
+        if (number_of_items >= 1 && density > conflict_bitset_density_threshold_) {
+            ItemPos number_of_words = instance_.number_of_bitset_words();
+            instance_.conflict_bitset_.assign(number_of_items * number_of_words, 0);
+            for (ItemId item_id = 0; item_id < number_of_items; ++item_id) {
+                for (ItemId item_id_neighbor: instance_.neighbors(item_id)) {
+                    instance_.conflict_bitset_[item_id * number_of_words + item_id_neighbor / 64]
+                        |= (uint64_t)1 << (item_id_neighbor % 64);
+                }
+            }
+        }
+    }
+
     /** Read an instance from a file in 'default' format. */
     void read_default(std::ifstream& file)
     {
@@ -362,6 +524,158 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Conflicts added to the instance. */
+    std::vector<std::pair<ItemId, ItemId>> conflicts_;
+
+    /** Density of the conflict graph above which the adjacency bitset is stored. */
+    double conflict_bitset_density_threshold_ = 1.0 / 64;
+
+};
+
+/**
+ * State of the bins of a partial solution of a 'bin_packing_with_conflicts'
+ * problem.
+ *
+ * Each bin keeps the bitset of the items which are in conflict with at least
+ * one of its items. Checking whether an item can be inserted into a bin is
+ * thus a single bit test, and inserting an item ORs its row of the adjacency
+ * bitset into the bitset of the bin (or sets the bits of its neighbors if the
+ * adjacency bitset is not stored).
+ */
+class BinsState
+{
+
+public:
+
+    /** Constructor; initially, there is no bin. */
+    BinsState(const Instance& instance):
+        instance_(instance),
+        number_of_words_(instance.number_of_bitset_words()),
+        bin_ids_(instance.number_of_items(), -1)
+    {
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of bins. */
+    inline BinId number_of_bins() const { return weights_.size(); }
+
+    /** Get the bin of an item, -1 if it is not packed. */
+    inline BinId bin_id(ItemId item_id) const { return bin_ids_[item_id]; }
+
+    /** Get the weight of a bin. */
+    inline Weight weight(BinId bin_id) const { return weights_[bin_id]; }
+
+    /** Get the items of a bin. */
+    inline const std::vector<ItemId>& item_ids(BinId bin_id) const { return item_ids_[bin_id]; }
+
+    /** Return 'true' iff an item is in conflict with an item of a bin. */
+    inline bool forbidden(
+            ItemId item_id,
+            BinId bin_id) const
+    {
+        return (forbidden_[bin_id * number_of_words_ + item_id / 64] >> (item_id % 64)) & 1;
+    }
+
+    /** Return 'true' iff an item can be inserted into a bin. */
+    inline bool insertion_feasible(
+            ItemId item_id,
+            BinId bin_id) const
+    {
+        return weight(bin_id) + instance_.item(item_id).weight <= instance_.capacity()
+            && !forbidden(item_id, bin_id);
+    }
+
+    /*
+     * Setters
+     */
+
+    /** Add an empty bin and return its id. */
+    BinId add_bin()
+    {
+        weights_.push_back(0);
+        item_ids_.push_back({});
+        forbidden_.resize(forbidden_.size() + number_of_words_, 0);
+        return number_of_bins() - 1;
+    }
+
+    /** Insert an unpacked item into a bin. */
+    void add(
+            ItemId item_id,
+            BinId bin_id)
+    {
+        bin_ids_[item_id] = bin_id;
+        weights_[bin_id] += instance_.item(item_id).weight;
+        item_ids_[bin_id].push_back(item_id);
+        add_conflicts(item_id, bin_id);
+    }
+
+    /**
+     * Remove a packed item from its bin.
+     *
+     * The bitset of the bin is recomputed from its remaining items.
+     */
+    void remove(ItemId item_id)
+    {
+        BinId bin_id = bin_ids_[item_id];
+        bin_ids_[item_id] = -1;
+        weights_[bin_id] -= instance_.item(item_id).weight;
+        std::vector<ItemId>& item_ids = item_ids_[bin_id];
+        item_ids.erase(std::find(item_ids.begin(), item_ids.end(), item_id));
+        std::fill(
+                forbidden_.begin() + bin_id * number_of_words_,
+                forbidden_.begin() + (bin_id + 1) * number_of_words_,
+                0);
+        for (ItemId item_id_2: item_ids)
+            add_conflicts(item_id_2, bin_id);
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Add the neighbors of an item to the bitset of a bin. */
+    void add_conflicts(
+            ItemId item_id,
+            BinId bin_id)
+    {
+        uint64_t* forbidden = forbidden_.data() + bin_id * number_of_words_;
+        if (instance_.has_conflict_bitset()) {
+            const uint64_t* row = instance_.conflict_bitset_row(item_id);
+            for (ItemPos word_pos = 0; word_pos < number_of_words_; ++word_pos)
+                forbidden[word_pos] |= row[word_pos];
+        } else {
+            for (ItemId item_id_neighbor: instance_.neighbors(item_id))
+                forbidden[item_id_neighbor / 64] |= (uint64_t)1 << (item_id_neighbor % 64);
+        }
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Number of 64-bit words of the bitset of a bin. */
+    ItemPos number_of_words_;
+
+    /** Bin of each item, -1 if it is not packed. */
+    std::vector<BinId> bin_ids_;
+
+    /** Weight of each bin. */
+    std::vector<Weight> weights_;
+
+    /** Items of each bin. */
+    std::vector<std::vector<ItemId>> item_ids_;
+
+    /** Bitsets of the items in conflict with the items of each bin. */
+    std::vector<uint64_t> forbidden_;
+
 };
 
 }
@@ -14,10 +14,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <vector>
 #include <iomanip>
+#include <limits>
 
 namespace orproblems
 {
@@ -29,6 +31,8 @@ using ItemPos = int64_t;
 using Weight = int64_t;
 using Demand = int64_t;
 using BinId = int64_t;
+using NodeId = int64_t;
+using ArcId = int64_t;
 
 /**
  * Structure for an item type.
@@ -108,7 +112,21 @@ public:
         }
     }
 
-    /** Check a certificate. */
+    /**
+     * Check a certificate.
+     *
+     * The certificate lists patterns with their multiplicities:
+     *
+     *     <number of patterns>
+     *     <multiplicity> <number of item types> <item type> <copies> ...
+     *     ...
+     *
+     * A solution with one line per bin uses multiplicity 1 on each line.
+     * A multiplicity smaller than 1 or a negative number of copies makes the
+     * certificate infeasible.
+     * The certificate is checked in O(number of patterns × pattern length),
+     * whatever the number of bins.
+     */
     std::pair<bool, BinId> check(
             const std::string& certificate_path,
             std::ostream& os,
@@ -122,18 +140,21 @@ public:
 
         if (verbosity_level >= 2) {
             os << std::endl
-                << std::setw(12) << "Bin"
+                << std::setw(12) << "Pattern"
+                << std::setw(12) << "Mult."
                 << std::setw(12) << "Item type"
                 << std::setw(12) << "Weight"
                 << std::endl
-                << std::setw(12) << "---"
+                << std::setw(12) << "-------"
+                << std::setw(12) << "-----"
                 << std::setw(12) << "---------"
                 << std::setw(12) << "------"
                 << std::endl;
         }
 
         std::vector<Demand> demands(number_of_item_types(), 0);
-        BinId number_of_bins = -1;
+        BinId number_of_patterns = -1;
+        BinId number_of_bins = 0;
         BinId bin_number_of_copies = -1;
         ItemPos bin_number_of_items = -1;
         ItemTypeId item_type_id = -1;
@@ -141,22 +162,45 @@ public:
 
         ItemPos number_of_unsatisfied_demands = 0;
         BinId number_of_overweighted_bins = 0;
+        ItemPos number_of_invalid_numbers_of_copies = 0;
 
-        file >> number_of_bins;
-        for (BinId bin_pos = 0; bin_pos < number_of_bins; ++bin_pos) {
+        file >> number_of_patterns;
+        for (BinId pattern_pos = 0;
+                pattern_pos < number_of_patterns;
+                ++pattern_pos) {
             file >> bin_number_of_copies >> bin_number_of_items;
+            if (bin_number_of_copies < 1) {
+                number_of_invalid_numbers_of_copies++;
+                if (verbosity_level >= 2) {
+                    os << "Pattern " << pattern_pos
+                        << " has an invalid number of copies: "
+                        << bin_number_of_copies << "." << std::endl;
+                }
+            } else {
+                number_of_bins += bin_number_of_copies;
+            }
 
             Weight bin_weight = 0;
             for (ItemPos item_pos = 0;
                     item_pos < bin_number_of_items;
                     ++item_pos) {
                 file >> item_type_id >> item_copies;
+                if (item_copies < 0) {
+                    number_of_invalid_numbers_of_copies++;
+                    if (verbosity_level >= 2) {
+                        os << "Pattern " << pattern_pos
+                            << ", item type " << item_type_id
+                            << " has an invalid number of copies: "
+                            << item_copies << "." << std::endl;
+                    }
+                }
                 demands[item_type_id] += bin_number_of_copies * item_copies;
                 bin_weight += item_copies * item_type(item_type_id).weight;
 
                 if (verbosity_level >= 2) {
                     os
-                        << std::setw(12) << number_of_bins
+                        << std::setw(12) << pattern_pos
+                        << std::setw(12) << bin_number_of_copies
                         << std::setw(12) << item_type_id
                         << std::setw(12) << bin_weight
                         << std::endl;
@@ -164,9 +208,9 @@ public:
             }
 
             if (bin_weight > capacity()) {
-                number_of_overweighted_bins++;
+                number_of_overweighted_bins += std::max(bin_number_of_copies, (BinId)0);
                 if (verbosity_level >= 2) {
-                    os << "Bin " << number_of_bins - 1
+                    os << "Pattern " << pattern_pos
                         << " is overloaded." << std::endl;
                 }
             }
@@ -188,7 +232,8 @@ public:
 
         bool feasible
             = (number_of_unsatisfied_demands == 0)
-            && (number_of_overweighted_bins == 0);
+            && (number_of_overweighted_bins == 0)
+            && (number_of_invalid_numbers_of_copies == 0);
 
         if (verbosity_level >= 2)
             os << std::endl;
@@ -196,7 +241,9 @@ public:
             os
                 << "Number of unsatisfied demands:  " << number_of_unsatisfied_demands  << std::endl
                 << "Number of overweighted bins:    " << number_of_overweighted_bins << std::endl
+                << "Number of invalid copies:       " << number_of_invalid_numbers_of_copies << std::endl
                 << "Feasible:                       " << feasible << std::endl
+                << "Number of patterns:             " << number_of_patterns << std::endl
                 << "Number of bins:                 " << number_of_bins << std::endl
                 ;
         }
@@ -339,5 +386,252 @@ private:
 
 };
 
+/**
+ * Arc-flow graph of a 'cutting_stock' problem.
+ *
+ * The nodes correspond to the positions 0..c in a bin and each arc of an
+ * item type from position d to position d + wⱼ corresponds to packing an
+ * item of this type at position d. Each path from the source (position 0)
+ * to the sink (position c) corresponds to a pattern.
+ *
+ * The following reductions are applied:
+ * - The item types are considered by non-increasing weight, and an arc of an
+ *   item type starts at a position only if this position is reachable with
+ *   heavier item types, or with the previous copies of the same item type
+ *   (symmetry reduction).
+ * - Starting from a position reachable with heavier item types, at most
+ *   qⱼ consecutive arcs of an item type are added (demand-bounded
+ *   compression). Since chains starting from different positions may
+ *   overlap, a path may still contain more than qⱼ copies of an item type;
+ *   the demands are enforced by the covering constraints of the model.
+ * - Only the reachable positions are kept, and a loss arc links each of them
+ *   to the sink.
+ *
+ * Item types with a zero weight, a zero demand or a weight larger than the
+ * capacity are ignored.
+ *
+ * The graph is stored in compressed sparse row format, the nodes being
+ * sorted by position, which is a topological order. It can be built once and
+ * reused for every pricing call.
+ */
+class ArcFlowGraph
+{
+
+public:
+
+    /** Constructor. */
+    ArcFlowGraph(const Instance& instance):
+        pattern_copies_(instance.number_of_item_types(), 0)
+    {
+        Weight capacity = instance.capacity();
+
+        // Sort the item types by non-increasing weight.
+        std::vector<ItemTypeId> sorted_item_type_ids;
+        for (ItemTypeId item_type_id = 0;
+                item_type_id < instance.number_of_item_types();
+                ++item_type_id) {
+            const ItemType& item_type = instance.item_type(item_type_id);
+            if (item_type.weight > 0
+                    && item_type.weight <= capacity
+                    && item_type.demand > 0) {
+                sorted_item_type_ids.push_back(item_type_id);
+            }
+        }
+        std::stable_sort(
+                sorted_item_type_ids.begin(),
+                sorted_item_type_ids.end(),
+                [&instance](ItemTypeId item_type_id_1, ItemTypeId item_type_id_2)
+                {
+                    return instance.item_type(item_type_id_1).weight
+                        > instance.item_type(item_type_id_2).weight;
+                });
+
+        // Compute the item arcs, identified by their tail positions.
+        std::vector<bool> reachable(capacity + 1, false);
+        std::vector<ItemTypeId> marked(capacity + 1, -1);
+        std::vector<std::pair<Weight, ItemTypeId>> item_arcs;
+        reachable[0] = true;
+        for (ItemTypeId item_type_id: sorted_item_type_ids) {
+            const ItemType& item_type = instance.item_type(item_type_id);
+            // Positions are processed downwards so that the chains of the
+            // current item type only start from positions reachable with
+            // heavier item types.
+            for (Weight position = capacity - item_type.weight;
+                    position >= 0;
+                    --position) {
+                if (!reachable[position])
+                    continue;
+                Weight tail = position;
+                for (Demand copy = 0;
+                        copy < item_type.demand
+                        && tail + item_type.weight <= capacity;
+                        ++copy, tail += item_type.weight) {
+                    if (marked[tail] == item_type_id)
+                        continue;
+                    marked[tail] = item_type_id;
+                    item_arcs.push_back({tail, item_type_id});
+                    reachable[tail + item_type.weight] = true;
+                }
+            }
+        }
+
+        // Number the reachable positions; the sink is the last node.
+        std::vector<NodeId> node_ids(capacity + 1, -1);
+        reachable[capacity] = true;
+        for (Weight position = 0; position <= capacity; ++position) {
+            if (!reachable[position])
+                continue;
+            node_ids[position] = positions_.size();
+            positions_.push_back(position);
+        }
+
+        // Build the compressed sparse row representation.
+        NodeId sink = number_of_nodes() - 1;
+        arc_offsets_.assign(number_of_nodes() + 1, 0);
+        for (const auto& item_arc: item_arcs)
+            arc_offsets_[node_ids[item_arc.first] + 1]++;
+        for (NodeId node_id = 0; node_id < sink; ++node_id)
+            arc_offsets_[node_id + 1]++;
+        for (NodeId node_id = 0; node_id < number_of_nodes(); ++node_id)
+            arc_offsets_[node_id + 1] += arc_offsets_[node_id];
+        heads_.resize(arc_offsets_.back());
+        arc_item_type_ids_.resize(arc_offsets_.back());
+        std::vector<ArcId> arc_positions(arc_offsets_.begin(), arc_offsets_.end() - 1);
+        for (const auto& item_arc: item_arcs) {
+            NodeId tail = node_ids[item_arc.first];
+            ArcId arc_id = arc_positions[tail]++;
+            heads_[arc_id] = node_ids[item_arc.first + instance.item_type(item_arc.second).weight];
+            arc_item_type_ids_[arc_id] = item_arc.second;
+        }
+        for (NodeId node_id = 0; node_id < sink; ++node_id) {
+            ArcId arc_id = arc_positions[node_id]++;
+            heads_[arc_id] = sink;
+            arc_item_type_ids_[arc_id] = -1;
+        }
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of nodes. */
+    inline NodeId number_of_nodes() const { return positions_.size(); }
+
+    /** Get the number of arcs. */
+    inline ArcId number_of_arcs() const { return heads_.size(); }
+
+    /** Get the source. */
+    inline NodeId source() const { return 0; }
+
+    /** Get the sink. */
+    inline NodeId sink() const { return number_of_nodes() - 1; }
+
+    /** Get the position of a node. */
+    inline Weight position(NodeId node_id) const { return positions_[node_id]; }
+
+    /** Get the first arc leaving a node. */
+    inline ArcId first_arc(NodeId node_id) const { return arc_offsets_[node_id]; }
+
+    /** Get the arc following the last arc leaving a node. */
+    inline ArcId last_arc(NodeId node_id) const { return arc_offsets_[node_id + 1]; }
+
+    /** Get the head of an arc. */
+    inline NodeId head(ArcId arc_id) const { return heads_[arc_id]; }
+
+    /** Get the item type of an arc, -1 for a loss arc. */
+    inline ItemTypeId item_type_id(ArcId arc_id) const { return arc_item_type_ids_[arc_id]; }
+
+    /*
+     * Pricing
+     */
+
+    /**
+     * Compute a pattern of maximum value.
+     *
+     * 'values' contains the value of each item type. The pattern is returned
+     * as a list of (item type, number of copies) pairs.
+     */
+    double longest_path(
+            const std::vector<double>& values,
+            std::vector<std::pair<ItemTypeId, Demand>>& pattern)
+    {
+        path_values_.assign(number_of_nodes(), -std::numeric_limits<double>::infinity());
+        predecessor_arc_ids_.assign(number_of_nodes(), -1);
+        predecessor_node_ids_.assign(number_of_nodes(), -1);
+        path_values_[source()] = 0;
+        for (NodeId node_id = 0; node_id < number_of_nodes(); ++node_id) {
+            double path_value = path_values_[node_id];
+            if (path_value == -std::numeric_limits<double>::infinity())
+                continue;
+            for (ArcId arc_id = first_arc(node_id);
+                    arc_id < last_arc(node_id);
+                    ++arc_id) {
+                ItemTypeId item_type_id = arc_item_type_ids_[arc_id];
+                double path_value_next = (item_type_id == -1)?
+                    path_value:
+                    path_value + values[item_type_id];
+                NodeId head = heads_[arc_id];
+                if (path_values_[head] < path_value_next) {
+                    path_values_[head] = path_value_next;
+                    predecessor_arc_ids_[head] = arc_id;
+                    predecessor_node_ids_[head] = node_id;
+                }
+            }
+        }
+
+        // Retrieve the pattern. An item type may appear on several
+        // non-consecutive arcs of the path, so its copies are accumulated
+        // before being stored.
+        pattern.clear();
+        for (NodeId node_id = sink(); node_id != source();) {
+            ArcId arc_id = predecessor_arc_ids_[node_id];
+            ItemTypeId item_type_id = arc_item_type_ids_[arc_id];
+            if (item_type_id != -1) {
+                if (pattern_copies_[item_type_id] == 0)
+                    pattern.push_back({item_type_id, 0});
+                pattern_copies_[item_type_id]++;
+            }
+            node_id = predecessor_node_ids_[node_id];
+        }
+        std::reverse(pattern.begin(), pattern.end());
+        for (auto& item_type_copies: pattern) {
+            item_type_copies.second = pattern_copies_[item_type_copies.first];
+            pattern_copies_[item_type_copies.first] = 0;
+        }
+        return path_values_[sink()];
+    }
+
+private:
+
+    /*
+     * Private attributes
+     */
+
+    /** Positions of the nodes. */
+    std::vector<Weight> positions_;
+
+    /** Offsets of the arcs leaving each node in 'heads_'. */
+    std::vector<ArcId> arc_offsets_;
+
+    /** Heads of the arcs. */
+    std::vector<NodeId> heads_;
+
+    /** Item types of the arcs, -1 for loss arcs. */
+    std::vector<ItemTypeId> arc_item_type_ids_;
+
+    /** Values of the longest paths from the source to each node. */
+    std::vector<double> path_values_;
+
+    /** Last arc of the longest path from the source to each node. */
+    std::vector<ArcId> predecessor_arc_ids_;
+
+    /** Predecessor of each node on the longest path from the source. */
+    std::vector<NodeId> predecessor_node_ids_;
+
+    /** Number of copies of each item type in the pattern being retrieved. */
+    std::vector<Demand> pattern_copies_;
+
+};
+
 }
 }
@@ -274,7 +274,7 @@ public:
         Profit total_profit = 0;
         ItemId n = -1;  // Number of items in knapsack i.
         ItemId job_id = -1;
-        optimizationtools::IndexedSet items(n);
+        optimizationtools::IndexedSet items(number_of_items());
         optimizationtools::IndexedSet knapsack_classes(number_of_classes());
         std::vector<KnapsackId> class_number_of_knapsacks(number_of_classes(), 0);
         ItemPos number_of_duplicates = 0;
@@ -282,6 +282,7 @@ public:
             Weight total_weight = 0;
             file >> n;
             std::vector<ItemId> current_knapsack_items;
+            knapsack_classes.clear();
             for (ItemPos j_pos = 0; j_pos < n; ++j_pos) {
                 file >> job_id;
                 total_weight += item(job_id).weight;
@@ -294,7 +295,11 @@ public:
                         << "; Weight: " << total_weight
                         << "; Profit: " << total_profit
                         << std::endl;
-                knapsack_classes.add(item(job_id).class_id);
+                // Add the setup time of the class.
+                if (!knapsack_classes.contains(item(job_id).class_id)) {
+                    knapsack_classes.add(item(job_id).class_id);
+                    total_weight += item_class(item(job_id).class_id).setup_time;
+                }
 
                 // Check duplicates.
                 if (items.contains(job_id)) {
@@ -312,7 +317,7 @@ public:
                     os << "Knapsack " << i
                         << " has overweight: " << total_weight << "/" << capacity(i)
                         << std::endl;
-                overweight += (capacity(i) - total_weight);
+                overweight += (total_weight - capacity(i));
             }
             for (ClassId k: knapsack_classes)
                 class_number_of_knapsacks[k]++;
@@ -532,5 +537,343 @@ private:
 
 };
 
+/**
+ * Evaluator of the moves of a local search for a
+ * 'generalized_quadratic_multiple_knapsack' problem.
+ *
+ * It maintains:
+ * - the knapsack of each item
+ * - the weight of each knapsack, including the setup times of its classes
+ * - the number of items of each class in each knapsack, and the number of
+ *   knapsacks containing each class
+ * - a contribution table, which contains for each knapsack k and each item j
+ *   the profit of assigning j to k plus the sum of the profits of the pairs
+ *   formed by j and the other items of k
+ *
+ * The profit difference and the feasibility of inserting, removing,
+ * transferring or swapping items are computed in O(1). Applying a move
+ * updates the contribution table in O(n).
+ */
+class KnapsacksEvaluator
+{
+
+public:
+
+    /** Structure for the evaluation of a move. */
+    struct MoveEvaluation
+    {
+        /** Difference of profit. */
+        Profit profit_difference;
+
+        /**
+         * 'true' iff, after the move, the knapsacks receiving an item don't
+         * exceed their capacities and the classes entering a knapsack don't
+         * exceed their maximum numbers of knapsacks.
+         */
+        bool feasible;
+    };
+
+    /** Constructor; initially, no item is packed. */
+    KnapsacksEvaluator(const Instance& instance):
+        instance_(instance),
+        knapsack_ids_(instance.number_of_items(), -1),
+        weights_(instance.number_of_knapsacks(), 0),
+        class_numbers_of_items_(instance.number_of_classes() * instance.number_of_knapsacks(), 0),
+        class_numbers_of_knapsacks_(instance.number_of_classes(), 0),
+        contributions_(instance.number_of_knapsacks() * instance.number_of_items())
+    {
+        for (KnapsackId knapsack_id = 0;
+                knapsack_id < instance.number_of_knapsacks();
+                ++knapsack_id) {
+            for (ItemId item_id = 0; item_id < instance.number_of_items(); ++item_id) {
+                contributions_[knapsack_id * instance.number_of_items() + item_id]
+                    = instance.item_profit(item_id, knapsack_id);
+            }
+        }
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the knapsack of an item, -1 if it is not packed. */
+    inline KnapsackId knapsack_id(ItemId item_id) const { return knapsack_ids_[item_id]; }
+
+    /** Get the weight of a knapsack, including the setup times of its classes. */
+    inline Weight weight(KnapsackId knapsack_id) const { return weights_[knapsack_id]; }
+
+    /** Get the total profit. */
+    inline Profit profit() const { return profit_; }
+
+    /** Get the number of items of a class in a knapsack. */
+    inline ItemPos number_of_items(
+            ClassId class_id,
+            KnapsackId knapsack_id) const
+    {
+        return class_numbers_of_items_[class_id * instance_.number_of_knapsacks() + knapsack_id];
+    }
+
+    /** Get the number of knapsacks containing items of a class. */
+    inline KnapsackId number_of_knapsacks(ClassId class_id) const { return class_numbers_of_knapsacks_[class_id]; }
+
+    /**
+     * Get the profit of assigning an item to a knapsack plus the sum of the
+     * profits of the pairs formed by the item and the other items of the
+     * knapsack.
+     */
+    inline Profit contribution(
+            ItemId item_id,
+            KnapsackId knapsack_id) const
+    {
+        return contributions_[knapsack_id * instance_.number_of_items() + item_id];
+    }
+
+    /*
+     * Evaluate moves
+     */
+
+    /**
+     * Evaluate the transfer of an item into another knapsack.
+     *
+     * Both the initial knapsack of the item and the new one may be -1,
+     * meaning that the item is not packed.
+     */
+    inline MoveEvaluation transfer(
+            ItemId item_id,
+            KnapsackId knapsack_id) const
+    {
+        KnapsackId knapsack_id_old = this->knapsack_id(item_id);
+        if (knapsack_id == knapsack_id_old)
+            return {0, true};
+        const Item& item = instance_.item(item_id);
+        Profit profit_difference = 0;
+        bool feasible = true;
+        KnapsackId number_of_knapsacks_difference = 0;
+        if (knapsack_id_old != -1) {
+            profit_difference -= contribution(item_id, knapsack_id_old);
+            if (number_of_items(item.class_id, knapsack_id_old) == 1)
+                number_of_knapsacks_difference--;
+        }
+        if (knapsack_id != -1) {
+            profit_difference += contribution(item_id, knapsack_id);
+            feasible &= (weight(knapsack_id)
+                    + item.weight
+                    + setup_time_difference(knapsack_id, -1, item.class_id)
+                    <= instance_.capacity(knapsack_id));
+            if (number_of_items(item.class_id, knapsack_id) == 0)
+                number_of_knapsacks_difference++;
+        }
+        feasible &= (number_of_knapsacks_difference <= 0
+                || number_of_knapsacks(item.class_id) + number_of_knapsacks_difference
+                <= instance_.item_class(item.class_id).maximum_number_of_knapsacks);
+        return {profit_difference, feasible};
+    }
+
+    /** Evaluate the insertion of an unpacked item into a knapsack. */
+    inline MoveEvaluation insertion(
+            ItemId item_id,
+            KnapsackId knapsack_id) const
+    {
+        return transfer(item_id, knapsack_id);
+    }
+
+    /** Evaluate the removal of a packed item. */
+    inline MoveEvaluation removal(ItemId item_id) const { return transfer(item_id, -1); }
+
+    /**
+     * Evaluate the swap of the knapsacks of two items.
+     *
+     * One of the items may not be packed.
+     */
+    inline MoveEvaluation swap(
+            ItemId item_id_1,
+            ItemId item_id_2) const
+    {
+        KnapsackId knapsack_id_1 = knapsack_id(item_id_1);
+        KnapsackId knapsack_id_2 = knapsack_id(item_id_2);
+        if (knapsack_id_1 == knapsack_id_2)
+            return {0, true};
+        const Item& item_1 = instance_.item(item_id_1);
+        const Item& item_2 = instance_.item(item_id_2);
+        Profit pair_profit = instance_.pair_profit(item_id_1, item_id_2);
+        Profit profit_difference = 0;
+        bool feasible = true;
+        if (knapsack_id_1 != -1) {
+            profit_difference
+                += contribution(item_id_2, knapsack_id_1) - pair_profit
+                - contribution(item_id_1, knapsack_id_1);
+            feasible &= (weight(knapsack_id_1)
+                    - item_1.weight + item_2.weight
+                    + setup_time_difference(knapsack_id_1, item_1.class_id, item_2.class_id)
+                    <= instance_.capacity(knapsack_id_1));
+        }
+        if (knapsack_id_2 != -1) {
+            profit_difference
+                += contribution(item_id_1, knapsack_id_2) - pair_profit
+                - contribution(item_id_2, knapsack_id_2);
+            feasible &= (weight(knapsack_id_2)
+                    - item_2.weight + item_1.weight
+                    + setup_time_difference(knapsack_id_2, item_2.class_id, item_1.class_id)
+                    <= instance_.capacity(knapsack_id_2));
+        }
+
+        // Check the maximum number of knapsacks of the classes.
+        if (item_1.class_id != item_2.class_id) {
+            feasible &= class_feasible(item_1.class_id, knapsack_id_1, knapsack_id_2);
+            feasible &= class_feasible(item_2.class_id, knapsack_id_2, knapsack_id_1);
+        }
+        return {profit_difference, feasible};
+    }
+
+    /*
+     * Apply moves
+     */
+
+    /**
+     * Move an item into a knapsack.
+     *
+     * Both the initial knapsack of the item and the new one may be -1,
+     * meaning that the item is not packed.
+     */
+    void apply_transfer(
+            ItemId item_id,
+            KnapsackId knapsack_id)
+    {
+        KnapsackId knapsack_id_old = this->knapsack_id(item_id);
+        if (knapsack_id == knapsack_id_old)
+            return;
+        profit_ += transfer(item_id, knapsack_id).profit_difference;
+        knapsack_ids_[item_id] = knapsack_id;
+        const Item& item = instance_.item(item_id);
+        ItemPos* class_numbers_of_items = class_numbers_of_items_.data()
+            + item.class_id * instance_.number_of_knapsacks();
+        if (knapsack_id_old != -1) {
+            weights_[knapsack_id_old] += setup_time_difference(knapsack_id_old, item.class_id, -1) - item.weight;
+            class_numbers_of_items[knapsack_id_old]--;
+            if (class_numbers_of_items[knapsack_id_old] == 0)
+                class_numbers_of_knapsacks_[item.class_id]--;
+        }
+        if (knapsack_id != -1) {
+            weights_[knapsack_id] += setup_time_difference(knapsack_id, -1, item.class_id) + item.weight;
+            class_numbers_of_items[knapsack_id]++;
+            if (class_numbers_of_items[knapsack_id] == 1)
+                class_numbers_of_knapsacks_[item.class_id]++;
+        }
+
+        // Update the contributions.
+        ItemId number_of_items = instance_.number_of_items();
+        Profit* contributions_old = (knapsack_id_old == -1)? nullptr:
+            contributions_.data() + knapsack_id_old * number_of_items;
+        Profit* contributions_new = (knapsack_id == -1)? nullptr:
+            contributions_.data() + knapsack_id * number_of_items;
+        for (ItemId item_id_2 = 0; item_id_2 < number_of_items; ++item_id_2) {
+            if (item_id_2 == item_id)
+                continue;
+            Profit pair_profit = instance_.pair_profit(item_id, item_id_2);
+            if (contributions_old != nullptr)
+                contributions_old[item_id_2] -= pair_profit;
+            if (contributions_new != nullptr)
+                contributions_new[item_id_2] += pair_profit;
+        }
+    }
+
+    /** Insert an unpacked item into a knapsack. */
+    void apply_insertion(
+            ItemId item_id,
+            KnapsackId knapsack_id)
+    {
+        apply_transfer(item_id, knapsack_id);
+    }
+
+    /** Remove a packed item. */
+    void apply_removal(ItemId item_id) { apply_transfer(item_id, -1); }
+
+    /** Swap the knapsacks of two items. */
+    void apply_swap(
+            ItemId item_id_1,
+            ItemId item_id_2)
+    {
+        KnapsackId knapsack_id_1 = knapsack_id(item_id_1);
+        KnapsackId knapsack_id_2 = knapsack_id(item_id_2);
+        apply_transfer(item_id_1, knapsack_id_2);
+        apply_transfer(item_id_2, knapsack_id_1);
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /**
+     * Get the difference of setup times of a knapsack when an item of class
+     * 'class_id_out' leaves it and an item of class 'class_id_in' enters it.
+     *
+     * Each class may be -1 if no item leaves or enters the knapsack.
+     */
+    inline Weight setup_time_difference(
+            KnapsackId knapsack_id,
+            ClassId class_id_out,
+            ClassId class_id_in) const
+    {
+        if (class_id_out == class_id_in)
+            return 0;
+        Weight difference = 0;
+        if (class_id_out != -1 && number_of_items(class_id_out, knapsack_id) == 1)
+            difference -= instance_.item_class(class_id_out).setup_time;
+        if (class_id_in != -1 && number_of_items(class_id_in, knapsack_id) == 0)
+            difference += instance_.item_class(class_id_in).setup_time;
+        return difference;
+    }
+
+    /**
+     * Return 'true' iff the maximum number of knapsacks of a class is
+     * satisfied after an item of the class leaves a knapsack and another item
+     * of the class enters another knapsack.
+     *
+     * Each knapsack may be -1 if no item leaves or enters a knapsack.
+     */
+    inline bool class_feasible(
+            ClassId class_id,
+            KnapsackId knapsack_id_out,
+            KnapsackId knapsack_id_in) const
+    {
+        KnapsackId number_of_knapsacks_difference = 0;
+        if (knapsack_id_out != -1 && number_of_items(class_id, knapsack_id_out) == 1)
+            number_of_knapsacks_difference--;
+        if (knapsack_id_in != -1 && number_of_items(class_id, knapsack_id_in) == 0)
+            number_of_knapsacks_difference++;
+        return number_of_knapsacks_difference <= 0
+            || number_of_knapsacks(class_id) + number_of_knapsacks_difference
+            <= instance_.item_class(class_id).maximum_number_of_knapsacks;
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Knapsack of each item, -1 if it is not packed. */
+    std::vector<KnapsackId> knapsack_ids_;
+
+    /** Weight of each knapsack, including the setup times of its classes. */
+    std::vector<Weight> weights_;
+
+    /** Number of items of each class in each knapsack, laid out [class][knapsack]. */
+    std::vector<ItemPos> class_numbers_of_items_;
+
+    /** Number of knapsacks containing items of each class. */
+    std::vector<KnapsackId> class_numbers_of_knapsacks_;
+
+    /** Total profit. */
+    Profit profit_ = 0;
+
+    /** Contribution table, laid out [knapsack][item]. */
+    std::vector<Profit> contributions_;
+
+};
+
 }
 }
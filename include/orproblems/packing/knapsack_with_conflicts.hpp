@@ -20,6 +20,8 @@
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -44,9 +46,25 @@ struct Item
 
     /** Profit of the item. */
     Profit profit = 0;
+};
+
+/**
+ * Structure for the neighbors of an item in the conflict graph.
+ */
+struct Neighbors
+{
+    /** Pointer to the first neighbor. */
+    const ItemId* first;
 
-    /** Conflicting items. */
-    std::vector<ItemId> neighbors;
+    /** Pointer past the last neighbor. */
+    const ItemId* last;
+
+    const ItemId* begin() const { return first; }
+
+    const ItemId* end() const { return last; }
+
+    /** Get the number of neighbors. */
+    ItemPos size() const { return last - first; }
 };
 
 /**
@@ -76,6 +94,37 @@ public:
     /** Get the number of conflicts. */
     inline ItemPos number_of_conflicts() const { return number_of_conflicts_; }
 
+    /** Get the neighbors of an item in the conflict graph, sorted by id. */
+    inline Neighbors neighbors(ItemId item_id) const
+    {
+        return {
+            neighbors_.data() + neighbors_offsets_[item_id],
+            neighbors_.data() + neighbors_offsets_[item_id + 1]};
+    }
+
+    /** Return 'true' iff the conflict graph is also stored as an adjacency bitset. */
+    inline bool has_conflict_bitset() const { return !conflict_bitset_.empty(); }
+
+    /**
+     * Return 'true' iff two items are in conflict.
+     *
+     * It runs in O(1) if the adjacency bitset is stored and in
+     * O(log(number of neighbors)) otherwise.
+     */
+    inline bool conflict(
+            ItemId item_id_1,
+            ItemId item_id_2) const
+    {
+        if (has_conflict_bitset()) {
+            return (conflict_bitset_[item_id_1 * conflict_bitset_number_of_words_ + item_id_2 / 64]
+                    >> (item_id_2 % 64)) & 1;
+        }
+        return std::binary_search(
+                neighbors_.begin() + neighbors_offsets_[item_id_1],
+                neighbors_.begin() + neighbors_offsets_[item_id_1 + 1],
+                item_id_2);
+    }
+
     /*
      * Outputs
      */
@@ -117,7 +166,7 @@ public:
                     << std::setw(12) << item.profit
                     << std::setw(12) << item.weight
                     << std::setw(12) << (double)item.profit / item.weight
-                    << std::setw(12) << item.neighbors.size()
+                    << std::setw(12) << neighbors(item_id).size()
                     << std::endl;
             }
         }
@@ -132,7 +181,7 @@ public:
                 << std::setw(12) << "------"
                 << std::endl;
             for (ItemId item_id = 0; item_id < number_of_items(); ++item_id) {
-                for (ItemId item_id_neighbor: item(item_id).neighbors) {
+                for (ItemId item_id_neighbor: neighbors(item_id)) {
                     os
                         << std::setw(12) << item_id
                         << std::setw(12) << item_id_neighbor
@@ -195,7 +244,7 @@ public:
             items.add(item_id);
 
             // Check conflict violations.
-            for (ItemId item_id_con: item(item_id).neighbors) {
+            for (ItemId item_id_con: neighbors(item_id)) {
                 if (items.contains(item_id_con)) {
                     number_of_conflict_violations++;
                     if (verbosity_level >= 2) {
@@ -256,6 +305,18 @@ private:
     /** Total weight of the items. */
     Weight total_weight_ = 0;
 
+    /** Offsets of the neighbors of each item in 'neighbors_'. */
+    std::vector<ItemPos> neighbors_offsets_;
+
+    /** Neighbors of the items, sorted and without duplicates. */
+    std::vector<ItemId> neighbors_;
+
+    /** Number of 64-bit words of a row of the adjacency bitset. */
+    ItemPos conflict_bitset_number_of_words_ = 0;
+
+    /** Adjacency bitset of the conflict graph; empty if not stored. */
+    std::vector<uint64_t> conflict_bitset_;
+
     friend class InstanceBuilder;
 };
 
@@ -294,14 +355,28 @@ public:
         instance_.items_[item_id].profit = profit;
     }
 
-    /** Add a conflict between two items. */
+    /**
+     * Add a conflict between two items.
+     *
+     * Duplicate conflicts are removed when building the instance.
+     */
     void add_conflict(
             ItemId item_id_1,
             ItemId item_id_2)
     {
-        instance_.items_[item_id_1].neighbors.push_back(item_id_2);
-        instance_.items_[item_id_2].neighbors.push_back(item_id_1);
-        instance_.number_of_conflicts_++;
+        conflicts_.push_back({item_id_1, item_id_2});
+    }
+
+    /**
+     * Set the density of the conflict graph above which it is also stored as
+     * an adjacency bitset.
+     *
+     * With the default value, the bitset is stored when it is smaller than
+     * the adjacency lists.
+     */
+    void set_conflict_bitset_density_threshold(double conflict_bitset_density_threshold)
+    {
+        conflict_bitset_density_threshold_ = conflict_bitset_density_threshold;
     }
 
     /** Set the capacity of the knapsack. */
@@ -344,6 +419,8 @@ public:
             instance_.total_weight_ += item.weight;
         }
 
+        compute_conflict_graph();
+
         return std::move(instance_);
     }
 
@@ -353,6 +430,73 @@ private:
      * Private methods
      */
 
+    /**
+     * Compute the adjacency lists of the conflict graph, and its adjacency
+     * bitset if it is dense enough.
+     */
+    void compute_conflict_graph()
+    {
+        ItemId number_of_items = instance_.number_of_items();
+
+        // Build the adjacency lists in a single array.
+        std::vector<ItemPos>& offsets = instance_.neighbors_offsets_;
+        std::vector<ItemId>& neighbors = instance_.neighbors_;
+        offsets.assign(number_of_items + 1, 0);
+        for (const auto& conflict: conflicts_) {
+            offsets[conflict.first + 1]++;
+            if (conflict.second != conflict.first)
+                offsets[conflict.second + 1]++;
+        }
+        for (ItemId item_id = 0; item_id < number_of_items; ++item_id)
+            offsets[item_id + 1] += offsets[item_id];
+        neighbors.resize(offsets[number_of_items]);
+        std::vector<ItemPos> positions(offsets.begin(), offsets.end() - 1);
+        for (const auto& conflict: conflicts_) {
+            neighbors[positions[conflict.first]++] = conflict.second;
+            if (conflict.second != conflict.first)
+                neighbors[positions[conflict.second]++] = conflict.first;
+        }
+
+        // Sort the adjacency lists and remove duplicates.
+        ItemPos pos_new = 0;
+        ItemPos number_of_self_conflicts = 0;
+        for (ItemId item_id = 0; item_id < number_of_items; ++item_id) {
+            auto first = neighbors.begin() + offsets[item_id];
+            auto last = neighbors.begin() + offsets[item_id + 1];
+            std::sort(first, last);
+            last = std::unique(first, last);
+            offsets[item_id] = pos_new;
+            for (auto it = first; it != last; ++it) {
+                if (*it == item_id)
+                    number_of_self_conflicts++;
+                neighbors[pos_new++] = *it;
+            }
+        }
+        offsets[number_of_items] = pos_new;
+        neighbors.resize(pos_new);
+        neighbors.shrink_to_fit();
+        instance_.number_of_conflicts_
+            = (pos_new - number_of_self_conflicts) / 2
+            + number_of_self_conflicts;
+
+        // Build the adjacency bitset.
+        instance_.conflict_bitset_number_of_words_ = 0;
+        instance_.conflict_bitset_.clear();
+        double density = (number_of_items <= 1)? 0:
+            (double)pos_new / number_of_items / (number_of_items - 1);
+        if (number_of_items >= 1 && density > conflict_bitset_density_threshold_) {
+            ItemPos number_of_words = (number_of_items + 63) / 64;
+            instance_.conflict_bitset_number_of_words_ = number_of_words;
+            instance_.conflict_bitset_.assign(number_of_items * number_of_words, 0);
+            for (ItemId item_id = 0; item_id < number_of_items; ++item_id) {
+                for (ItemId item_id_neighbor: instance_.neighbors(item_id)) {
+                    instance_.conflict_bitset_[item_id * number_of_words + item_id_neighbor / 64]
+                        |= (uint64_t)1 << (item_id_neighbor % 64);
+                }
+            }
+        }
+    }
+
     /** Read an instance from a file in 'hifi2006' format. */
     void read_hifi2006(std::ifstream& file)
     {
@@ -424,6 +568,304 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Conflicts added to the instance. */
+    std::vector<std::pair<ItemId, ItemId>> conflicts_;
+
+    /** Density of the conflict graph above which the adjacency bitset is stored. */
+    double conflict_bitset_density_threshold_ = 1.0 / 64;
+
+};
+
+/**
+ * Reduction of a 'knapsack_with_conflicts' instance.
+ *
+ * The following reductions are applied:
+ * - Items heavier than the capacity, items with a non-positive profit and
+ *   items in conflict with themselves are removed.
+ * - An item j is removed if it is in conflict with an item i such that
+ *   wᵢ <= wⱼ, pᵢ >= pⱼ and each other item in conflict with i is in conflict
+ *   with j. Indeed, in any solution containing j, replacing j by i yields a
+ *   solution at least as good.
+ * - An item without conflicts is fixed if the total weight of the remaining
+ *   items fits in the capacity, or if the upper bound of the linear
+ *   relaxation without conflicts of the problem without the item is strictly
+ *   lower than the profit of a greedy solution. In the latter case, every
+ *   optimal solution contains the item.
+ *
+ * The reduced instance contains the remaining items and its capacity is the
+ * capacity of the original instance minus the weight of the fixed items.
+ */
+class Reduction
+{
+
+public:
+
+    /** Constructor. */
+    Reduction(const Instance& instance):
+        instance_(instance),
+        removed_(instance.number_of_items(), false),
+        fixed_(instance.number_of_items(), false),
+        reduced_instance_(reduce())
+    {
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the reduced instance. */
+    inline const Instance& instance() const { return reduced_instance_; }
+
+    /** Get the id in the original instance of an item of the reduced instance. */
+    inline ItemId original_item_id(ItemId item_id) const { return original_item_ids_[item_id]; }
+
+    /** Get the ids in the original instance of the fixed items. */
+    inline const std::vector<ItemId>& fixed_item_ids() const { return fixed_item_ids_; }
+
+    /** Get the total weight of the fixed items. */
+    inline Weight fixed_weight() const { return fixed_weight_; }
+
+    /** Get the total profit of the fixed items. */
+    inline Profit fixed_profit() const { return fixed_profit_; }
+
+    /** Get the number of removed items. */
+    inline ItemPos number_of_removed_items() const { return number_of_removed_items_; }
+
+    /**
+     * Convert a solution of the reduced instance into a solution of the
+     * original instance.
+     */
+    std::vector<ItemId> unreduce_solution(
+            const std::vector<ItemId>& item_ids) const
+    {
+        std::vector<ItemId> original_item_ids = fixed_item_ids_;
+        for (ItemId item_id: item_ids)
+            original_item_ids.push_back(original_item_id(item_id));
+        return original_item_ids;
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Apply the reductions and build the reduced instance. */
+    Instance reduce()
+    {
+        const Instance& instance = instance_;
+        ItemId number_of_items = instance.number_of_items();
+
+        remove_useless_items();
+        remove_dominated_items();
+        fix_items();
+
+        // Build the reduced instance.
+        std::vector<ItemId> reduced_item_ids(number_of_items, -1);
+        InstanceBuilder instance_builder;
+        instance_builder.set_capacity(instance.capacity() - fixed_weight_);
+        for (ItemId item_id = 0; item_id < number_of_items; ++item_id) {
+            if (removed_[item_id] || fixed_[item_id])
+                continue;
+            const Item& item = instance.item(item_id);
+            reduced_item_ids[item_id] = original_item_ids_.size();
+            original_item_ids_.push_back(item_id);
+            instance_builder.add_item(item.weight, item.profit);
+        }
+        for (ItemId item_id: original_item_ids_) {
+            for (ItemId item_id_neighbor: instance.neighbors(item_id)) {
+                if (item_id_neighbor < item_id
+                        || reduced_item_ids[item_id_neighbor] == -1) {
+                    continue;
+                }
+                instance_builder.add_conflict(
+                        reduced_item_ids[item_id],
+                        reduced_item_ids[item_id_neighbor]);
+            }
+        }
+        return instance_builder.build();
+    }
+
+    /** Remove an item. */
+    void remove(ItemId item_id)
+    {
+        removed_[item_id] = true;
+        number_of_removed_items_++;
+    }
+
+    /** Remove the items which can't be part of an optimal solution alone. */
+    void remove_useless_items()
+    {
+        for (ItemId item_id = 0; item_id < instance_.number_of_items(); ++item_id) {
+            const Item& item = instance_.item(item_id);
+            if (item.weight > instance_.capacity()
+                    || item.profit <= 0
+                    || instance_.conflict(item_id, item_id)) {
+                remove(item_id);
+            }
+        }
+    }
+
+    /**
+     * Return 'true' iff each remaining item other than 'item_id_2' in conflict
+     * with item 'item_id_1' is in conflict with item 'item_id_2'.
+     */
+    bool included(
+            ItemId item_id_1,
+            ItemId item_id_2) const
+    {
+        Neighbors neighbors_1 = instance_.neighbors(item_id_1);
+        Neighbors neighbors_2 = instance_.neighbors(item_id_2);
+        const ItemId* it_2 = neighbors_2.begin();
+        for (ItemId item_id: neighbors_1) {
+            if (item_id == item_id_2 || removed_[item_id])
+                continue;
+            while (it_2 != neighbors_2.end() && *it_2 < item_id)
+                ++it_2;
+            if (it_2 == neighbors_2.end() || *it_2 != item_id)
+                return false;
+        }
+        return true;
+    }
+
+    /** Remove the dominated items. */
+    void remove_dominated_items()
+    {
+        for (ItemId item_id = 0; item_id < instance_.number_of_items(); ++item_id) {
+            if (removed_[item_id])
+                continue;
+            const Item& item = instance_.item(item_id);
+            for (ItemId item_id_neighbor: instance_.neighbors(item_id)) {
+                if (item_id_neighbor == item_id || removed_[item_id_neighbor])
+                    continue;
+                const Item& item_neighbor = instance_.item(item_id_neighbor);
+                if (item_neighbor.weight <= item.weight
+                        && item_neighbor.profit >= item.profit
+                        && included(item_id_neighbor, item_id)) {
+                    remove(item_id);
+                    break;
+                }
+            }
+        }
+    }
+
+    /** Fix the items without conflicts which belong to an optimal solution. */
+    void fix_items()
+    {
+        // Sort the remaining items by non-increasing efficiency.
+        std::vector<ItemId> sorted_item_ids;
+        for (ItemId item_id = 0; item_id < instance_.number_of_items(); ++item_id)
+            if (!removed_[item_id])
+                sorted_item_ids.push_back(item_id);
+        std::sort(
+                sorted_item_ids.begin(),
+                sorted_item_ids.end(),
+                [this](ItemId item_id_1, ItemId item_id_2)
+                {
+                    const Item& item_1 = instance_.item(item_id_1);
+                    const Item& item_2 = instance_.item(item_id_2);
+                    return item_1.profit * item_2.weight > item_2.profit * item_1.weight;
+                });
+        ItemPos n = sorted_item_ids.size();
+
+        // Compute a greedy solution.
+        std::vector<bool> forbidden(instance_.number_of_items(), false);
+        Weight greedy_weight = 0;
+        Profit greedy_profit = 0;
+        for (ItemId item_id: sorted_item_ids) {
+            const Item& item = instance_.item(item_id);
+            if (forbidden[item_id]
+                    || greedy_weight + item.weight > instance_.capacity()) {
+                continue;
+            }
+            greedy_weight += item.weight;
+            greedy_profit += item.profit;
+            for (ItemId item_id_neighbor: instance_.neighbors(item_id))
+                forbidden[item_id_neighbor] = true;
+        }
+
+        // Compute the prefix weights and profits.
+        std::vector<Weight> weights(n + 1, 0);
+        std::vector<Profit> profits(n + 1, 0);
+        for (ItemPos pos = 0; pos < n; ++pos) {
+            const Item& item = instance_.item(sorted_item_ids[pos]);
+            weights[pos + 1] = weights[pos] + item.weight;
+            profits[pos + 1] = profits[pos] + item.profit;
+        }
+
+        for (ItemPos pos = 0; pos < n; ++pos) {
+            ItemId item_id = sorted_item_ids[pos];
+            const Item& item = instance_.item(item_id);
+            bool in_conflict = false;
+            for (ItemId item_id_neighbor: instance_.neighbors(item_id)) {
+                if (!removed_[item_id_neighbor]) {
+                    in_conflict = true;
+                    break;
+                }
+            }
+            if (in_conflict)
+                continue;
+
+            bool fix = (weights[n] <= instance_.capacity());
+            if (!fix) {
+                // Compute the upper bound without the item. The critical item
+                // is the first one which doesn't fit once the item is removed.
+                ItemPos pos_critical = std::upper_bound(
+                        weights.begin() + pos + 1,
+                        weights.end(),
+                        instance_.capacity() + item.weight) - weights.begin() - 1;
+                if (pos_critical >= pos + 1) {
+                    Weight weight = weights[pos_critical] - item.weight;
+                    Profit profit = profits[pos_critical] - item.profit;
+                    if (pos_critical < n) {
+                        const Item& item_critical = instance_.item(sorted_item_ids[pos_critical]);
+                        profit += item_critical.profit
+                            * (instance_.capacity() - weight) / item_critical.weight;
+                    }
+                    fix = (profit < greedy_profit);
+                }
+            }
+            if (fix) {
+                fixed_[item_id] = true;
+                fixed_item_ids_.push_back(item_id);
+                fixed_weight_ += item.weight;
+                fixed_profit_ += item.profit;
+            }
+        }
+        std::sort(fixed_item_ids_.begin(), fixed_item_ids_.end());
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Original instance. */
+    const Instance& instance_;
+
+    /** For each item of the reduced instance, its id in the original instance. */
+    std::vector<ItemId> original_item_ids_;
+
+    /** For each item of the original instance, 'true' iff it has been removed. */
+    std::vector<bool> removed_;
+
+    /** For each item of the original instance, 'true' iff it has been fixed. */
+    std::vector<bool> fixed_;
+
+    /** Ids in the original instance of the fixed items. */
+    std::vector<ItemId> fixed_item_ids_;
+
+    /** Number of removed items. */
+    ItemPos number_of_removed_items_ = 0;
+
+    /** Total weight of the fixed items. */
+    Weight fixed_weight_ = 0;
+
+    /** Total profit of the fixed items. */
+    Profit fixed_profit_ = 0;
+
+    /** Reduced instance; it must be initialized last. */
+    Instance reduced_instance_;
+
 };
 
 }
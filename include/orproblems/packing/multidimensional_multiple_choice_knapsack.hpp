@@ -21,9 +21,12 @@
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 namespace orproblems
 {
@@ -38,14 +41,14 @@ using Weight = int64_t;
 
 /*
  * Structure for an item.
+ *
+ * The weights of the items are stored separately in the instance, see
+ * 'Instance::weights'.
  */
 struct Item
 {
     /** Profit. */
     Profit profit;
-
-    /** Weights. */
-    std::vector<Weight> weights;
 };
 
 /**
@@ -61,21 +64,21 @@ public:
      */
 
     /** Get the number of groups. */
-    inline GroupId number_of_groups() const { return groups_.size(); }
+    inline GroupId number_of_groups() const { return group_offsets_.size() - 1; }
 
     /** Get the number of items. */
-    inline GroupId number_of_items() const { return number_of_items_; }
+    inline GroupId number_of_items() const { return items_.size(); }
 
     /** Get an item. */
     inline const Item& item(
             GroupId group_id,
             ItemId item_id) const
     {
-        return groups_[group_id][item_id];
+        return items_[group_offsets_[group_id] + item_id];
     }
 
     /** Get the number of items in a group. */
-    inline ItemId number_of_items(GroupId group_id) const { return groups_[group_id].size(); }
+    inline ItemId number_of_items(GroupId group_id) const { return group_offsets_[group_id + 1] - group_offsets_[group_id]; }
 
     /** Get the largest group size */
     inline ItemId largest_group_size() const { return largest_group_size_; }
@@ -86,6 +89,76 @@ public:
     /** Get the capacity of a resource. */
     inline Weight capacity(ResourceId resource_id) const { return capacities_[resource_id]; }
 
+    /** Get the capacities of the resources. */
+    inline const Weight* capacities() const { return capacities_.data(); }
+
+    /** Get the weight of an item for a resource. */
+    inline Weight weight(
+            GroupId group_id,
+            ItemId item_id,
+            ResourceId resource_id) const
+    {
+        return weights(group_id, item_id)[resource_id];
+    }
+
+    /**
+     * Get the weights of an item.
+     *
+     * The weights of the items of a group are contiguous, each item using
+     * 'weights_stride()' values, the extra ones being zero.
+     */
+    inline const Weight* weights(
+            GroupId group_id,
+            ItemId item_id) const
+    {
+        return weights_.data() + (group_offsets_[group_id] + item_id) * weights_stride_;
+    }
+
+    /** Get the number of weight values stored for each item. */
+    inline ResourceId weights_stride() const { return weights_stride_; }
+
+    /*
+     * Feasibility checks
+     */
+
+    /**
+     * Return 'true' iff an item fits in the given residual capacities.
+     *
+     * The loop doesn't branch so that it gets vectorized.
+     */
+    inline bool fits(
+            GroupId group_id,
+            ItemId item_id,
+            const Weight* residual_capacities) const
+    {
+        const Weight* weights = this->weights(group_id, item_id);
+        Weight overflow = 0;
+        for (ResourceId resource_id = 0;
+                resource_id < number_of_resources();
+                ++resource_id) {
+            overflow |= residual_capacities[resource_id] - weights[resource_id];
+        }
+        return overflow >= 0;
+    }
+
+    /**
+     * Compute the items of a group which fit in the given residual
+     * capacities.
+     */
+    void fitting_items(
+            GroupId group_id,
+            const Weight* residual_capacities,
+            std::vector<ItemId>& item_ids) const
+    {
+        item_ids.clear();
+        for (ItemId item_id = 0;
+                item_id < number_of_items(group_id);
+                ++item_id) {
+            if (fits(group_id, item_id, residual_capacities))
+                item_ids.push_back(item_id);
+        }
+    }
+
     /*
      * Outputs
      */
@@ -181,7 +254,6 @@ public:
                 for (ItemId item_id = 0;
                         item_id < number_of_items(group_id);
                         ++item_id) {
-                    const Item& item = this->item(group_id, item_id);
                     for (ResourceId resource_id = 0;
                             resource_id < number_of_resources();
                             ++resource_id) {
@@ -189,7 +261,7 @@ public:
                             << std::setw(12) << group_id
                             << std::setw(12) << item_id
                             << std::setw(12) << resource_id
-                            << std::setw(12) << item.weights[resource_id]
+                            << std::setw(12) << weight(group_id, item_id, resource_id)
                             << std::endl;
                     }
                 }
@@ -227,10 +299,11 @@ public:
         ItemId item_id = -1;
         while (file >> item_id) {
             const Item& item = this->item(group_id, item_id);
+            const Weight* item_weights = this->weights(group_id, item_id);
             for (ResourceId resource_id = 0;
                     resource_id < number_of_resources();
                     ++resource_id) {
-                weights[resource_id] += item.weights[resource_id];
+                weights[resource_id] += item_weights[resource_id];
             }
             profit += item.profit;
 
@@ -285,11 +358,17 @@ private:
     /** Capacities. */
     std::vector<Weight> capacities_;
 
-    /** Groups. */
-    std::vector<std::vector<Item>> groups_;
+    /** Items, sorted by group. */
+    std::vector<Item> items_;
 
-    /** Number of items. */
-    ItemId number_of_items_ = 0;
+    /** Offsets of the items of each group in 'items_'. */
+    std::vector<ItemId> group_offsets_ = {0};
+
+    /** Weights of the items, laid out [item][resource]. */
+    std::vector<Weight> weights_;
+
+    /** Number of weight values stored for each item. */
+    ResourceId weights_stride_ = 0;
 
     /*
      * Computed attributes
@@ -318,6 +397,8 @@ public:
     {
         instance_ = Instance();
         instance_.capacities_ = std::vector<Weight>(number_of_resources);
+        groups_.clear();
+        group_weights_.clear();
     }
 
     /** Set the capacity of a resource. */
@@ -333,13 +414,17 @@ public:
             GroupId group_id,
             Profit profit)
     {
-        while ((GroupId)instance_.groups_.size() <= group_id)
-            instance_.groups_.push_back({});
+        while ((GroupId)groups_.size() <= group_id) {
+            groups_.push_back({});
+            group_weights_.push_back({});
+        }
 
         Item item;
         item.profit = profit;
-        item.weights.resize(instance_.number_of_resources(), 0);
-        instance_.groups_[group_id].push_back(item);
+        groups_[group_id].push_back(item);
+        group_weights_[group_id].resize(
+                group_weights_[group_id].size() + instance_.number_of_resources(),
+                0);
     }
 
     /** Set the weight of an item. */
@@ -349,7 +434,7 @@ public:
             ResourceId resource_id,
             Weight weight)
     {
-        instance_.groups_[group_id][item_id].weights[resource_id] = weight;
+        group_weights_[group_id][item_id * instance_.number_of_resources() + resource_id] = weight;
     }
 
     /** Build an instance from a file. */
@@ -382,17 +467,44 @@ public:
     /** Build the instance. */
     Instance build()
     {
-        // Compute largest group and number of items.
+        ResourceId number_of_resources = instance_.number_of_resources();
+
+        // Compute the group offsets and the largest group.
         instance_.largest_group_size_ = 0;
-        instance_.number_of_items_ = 0;
+        instance_.group_offsets_ = {0};
         for (GroupId group_id = 0;
-                group_id < instance_.number_of_groups();
+                group_id < (GroupId)groups_.size();
                 ++group_id) {
-            ItemId group_size = instance_.groups_[group_id].size();
+            ItemId group_size = groups_[group_id].size();
             if (instance_.largest_group_size_ < group_size)
                 instance_.largest_group_size_ = group_size;
-            instance_.number_of_items_ += group_size;
+            instance_.group_offsets_.push_back(
+                    instance_.group_offsets_.back() + group_size);
+        }
+
+        // Store the items and their weights contiguously. The stride is
+        // padded to a multiple of 8 values so that the weights of all items
+        // have the same alignment.
+        instance_.weights_stride_ = (number_of_resources + 7) / 8 * 8;
+        instance_.items_.clear();
+        instance_.weights_.assign(
+                instance_.group_offsets_.back() * instance_.weights_stride_,
+                0);
+        for (GroupId group_id = 0;
+                group_id < (GroupId)groups_.size();
+                ++group_id) {
+            for (ItemId item_id = 0;
+                    item_id < (ItemId)groups_[group_id].size();
+                    ++item_id) {
+                std::copy(
+                        group_weights_[group_id].begin() + item_id * number_of_resources,
+                        group_weights_[group_id].begin() + (item_id + 1) * number_of_resources,
+                        instance_.weights_.begin() + instance_.items_.size() * instance_.weights_stride_);
+                instance_.items_.push_back(groups_[group_id][item_id]);
+            }
         }
+        groups_.clear();
+        group_weights_.clear();
 
         return std::move(instance_);
     }
@@ -524,6 +636,335 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Items of each group. */
+    std::vector<std::vector<Item>> groups_;
+
+    /** Weights of the items of each group, laid out [item][resource]. */
+    std::vector<std::vector<Weight>> group_weights_;
+
+};
+
+/**
+ * Surrogate relaxation bound for a 'multidimensional_multiple_choice_knapsack'
+ * problem.
+ *
+ * Given non-negative multipliers λ, the resources are aggregated into a single
+ * one with weights aⱼ = Σᵢ λᵢ wⱼᵢ and capacity Σᵢ λᵢ cᵢ. The linear
+ * relaxation of the resulting multiple-choice knapsack problem is solved by
+ * taking the upper convex hull of the (aggregated weight, profit) points of
+ * each group and merging the segments of the hulls by non-increasing slope.
+ *
+ * Items which don't fit alone in the capacities are ignored.
+ *
+ * The hulls are computed when the multipliers are set. Fixing or unfixing a
+ * group runs in O(1) and computing the bound runs in O(k log k) where k is
+ * the number of free groups, plus O(log k) per segment merged.
+ */
+class SurrogateRelaxationBound
+{
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * The multipliers are initialized to the inverses of the capacities.
+     */
+    SurrogateRelaxationBound(const Instance& instance):
+        instance_(instance),
+        fixed_item_ids_(instance.number_of_groups(), -1)
+    {
+        group_offsets_.push_back(0);
+        for (GroupId group_id = 0; group_id < instance.number_of_groups(); ++group_id)
+            group_offsets_.push_back(group_offsets_.back() + instance.number_of_items(group_id));
+
+        std::vector<double> multipliers(instance.number_of_resources(), 1);
+        for (ResourceId resource_id = 0;
+                resource_id < instance.number_of_resources();
+                ++resource_id) {
+            if (instance.capacity(resource_id) > 0)
+                multipliers[resource_id] = 1.0 / instance.capacity(resource_id);
+        }
+        set_multipliers(multipliers);
+    }
+
+    /** Set the multipliers and compute the hulls of the groups. */
+    void set_multipliers(const std::vector<double>& multipliers)
+    {
+        if ((ResourceId)multipliers.size() != instance_.number_of_resources()) {
+            throw std::invalid_argument(
+                    "Wrong number of multipliers.");
+        }
+        for (double multiplier: multipliers) {
+            if (multiplier < 0) {
+                throw std::invalid_argument(
+                        "Multipliers must be non-negative.");
+            }
+        }
+        multipliers_ = multipliers;
+
+        aggregated_capacity_ = 0;
+        for (ResourceId resource_id = 0;
+                resource_id < instance_.number_of_resources();
+                ++resource_id) {
+            aggregated_capacity_ += multipliers_[resource_id] * instance_.capacity(resource_id);
+        }
+        tolerance_ = 1e-9 * aggregated_capacity_;
+
+        // Compute the aggregated weights of the items.
+        aggregated_weights_.resize(instance_.number_of_items());
+        feasible_.resize(instance_.number_of_items());
+        ItemId pos = 0;
+        for (GroupId group_id = 0; group_id < instance_.number_of_groups(); ++group_id) {
+            for (ItemId item_id = 0;
+                    item_id < instance_.number_of_items(group_id);
+                    ++item_id, ++pos) {
+                feasible_[pos] = instance_.fits(group_id, item_id, instance_.capacities());
+                const Weight* weights = instance_.weights(group_id, item_id);
+                double aggregated_weight = 0;
+                for (ResourceId resource_id = 0;
+                        resource_id < instance_.number_of_resources();
+                        ++resource_id) {
+                    aggregated_weight += multipliers_[resource_id] * weights[resource_id];
+                }
+                aggregated_weights_[pos] = aggregated_weight;
+            }
+        }
+
+        // Compute the hulls.
+        hull_offsets_.clear();
+        hull_item_ids_.clear();
+        hull_offsets_.push_back(0);
+        std::vector<ItemId> sorted_item_ids;
+        for (GroupId group_id = 0; group_id < instance_.number_of_groups(); ++group_id) {
+            ItemId group_pos = group_offsets_[group_id];
+            sorted_item_ids.clear();
+            for (ItemId item_id = 0;
+                    item_id < instance_.number_of_items(group_id);
+                    ++item_id) {
+                if (feasible_[group_pos + item_id])
+                    sorted_item_ids.push_back(item_id);
+            }
+            std::sort(
+                    sorted_item_ids.begin(),
+                    sorted_item_ids.end(),
+                    [this, group_id, group_pos](ItemId item_id_1, ItemId item_id_2)
+                    {
+                        double weight_1 = aggregated_weights_[group_pos + item_id_1];
+                        double weight_2 = aggregated_weights_[group_pos + item_id_2];
+                        if (weight_1 != weight_2)
+                            return weight_1 < weight_2;
+                        return instance_.item(group_id, item_id_1).profit
+                            > instance_.item(group_id, item_id_2).profit;
+                    });
+            ItemId hull_start = hull_item_ids_.size();
+            for (ItemId item_id: sorted_item_ids) {
+                double weight = aggregated_weights_[group_pos + item_id];
+                Profit profit = instance_.item(group_id, item_id).profit;
+                // Skip the items dominated by the last item of the hull.
+                if ((ItemId)hull_item_ids_.size() > hull_start
+                        && profit <= instance_.item(group_id, hull_item_ids_.back()).profit) {
+                    continue;
+                }
+                // Replace the last item of the hull if both aggregated
+                // weights only differ by rounding errors.
+                if ((ItemId)hull_item_ids_.size() > hull_start
+                        && weight - aggregated_weights_[group_pos + hull_item_ids_.back()] <= tolerance_) {
+                    hull_item_ids_.pop_back();
+                }
+                // Remove the items which are not on the upper hull anymore.
+                while ((ItemId)hull_item_ids_.size() >= hull_start + 2) {
+                    ItemId item_id_1 = hull_item_ids_[hull_item_ids_.size() - 2];
+                    ItemId item_id_2 = hull_item_ids_.back();
+                    double weight_1 = aggregated_weights_[group_pos + item_id_1];
+                    double weight_2 = aggregated_weights_[group_pos + item_id_2];
+                    Profit profit_1 = instance_.item(group_id, item_id_1).profit;
+                    Profit profit_2 = instance_.item(group_id, item_id_2).profit;
+                    if ((profit_2 - profit_1) * (weight - weight_2)
+                            > (profit - profit_2) * (weight_2 - weight_1)) {
+                        break;
+                    }
+                    hull_item_ids_.pop_back();
+                }
+                hull_item_ids_.push_back(item_id);
+            }
+            hull_offsets_.push_back(hull_item_ids_.size());
+        }
+    }
+
+    /** Fix the item selected in a group. */
+    void fix(
+            GroupId group_id,
+            ItemId item_id)
+    {
+        fixed_item_ids_[group_id] = item_id;
+    }
+
+    /** Unfix the item selected in a group. */
+    void unfix(GroupId group_id)
+    {
+        fixed_item_ids_[group_id] = -1;
+    }
+
+    /**
+     * Compute the bound.
+     *
+     * Since the aggregated weights are sums of floating-point products, they
+     * are compared to the aggregated capacity with a relative tolerance, so
+     * that the bound never underestimates the optimum because of rounding
+     * errors.
+     */
+    double bound()
+    {
+        // Compute the sums of the first points and of the fixed items.
+        double base_weight = 0;
+        double base_profit = 0;
+        for (GroupId group_id = 0; group_id < instance_.number_of_groups(); ++group_id) {
+            ItemId item_id = fixed_item_ids_[group_id];
+            if (item_id == -1) {
+                if (hull_offsets_[group_id] == hull_offsets_[group_id + 1])
+                    return -std::numeric_limits<double>::infinity();
+                item_id = hull_item_ids_[hull_offsets_[group_id]];
+            }
+            base_weight += aggregated_weight(group_id, item_id);
+            base_profit += instance_.item(group_id, item_id).profit;
+        }
+        if (base_weight > aggregated_capacity_ + tolerance_)
+            return -std::numeric_limits<double>::infinity();
+
+        // Initialize the heap with the first segment of each free group.
+        heap_.clear();
+        hull_positions_.resize(instance_.number_of_groups());
+        for (GroupId group_id = 0; group_id < instance_.number_of_groups(); ++group_id) {
+            if (fixed_item_ids_[group_id] != -1
+                    || hull_offsets_[group_id + 1] - hull_offsets_[group_id] <= 1) {
+                continue;
+            }
+            hull_positions_[group_id] = hull_offsets_[group_id];
+            heap_.push_back({slope(group_id, hull_offsets_[group_id]), group_id});
+        }
+        std::make_heap(heap_.begin(), heap_.end());
+
+        // Merge the segments.
+        double remaining_capacity = std::max(
+                aggregated_capacity_ + tolerance_ - base_weight,
+                0.0);
+        double bound = base_profit;
+        while (!heap_.empty()) {
+            GroupId group_id = heap_.front().second;
+            std::pop_heap(heap_.begin(), heap_.end());
+            heap_.pop_back();
+            ItemId hull_pos = hull_positions_[group_id];
+            double weight = aggregated_weight(group_id, hull_item_ids_[hull_pos + 1])
+                - aggregated_weight(group_id, hull_item_ids_[hull_pos]);
+            Profit profit = instance_.item(group_id, hull_item_ids_[hull_pos + 1]).profit
+                - instance_.item(group_id, hull_item_ids_[hull_pos]).profit;
+            if (weight > remaining_capacity) {
+                bound += profit * remaining_capacity / weight;
+                break;
+            }
+            remaining_capacity -= weight;
+            bound += profit;
+            hull_positions_[group_id]++;
+            if (hull_pos + 2 < hull_offsets_[group_id + 1]) {
+                heap_.push_back({slope(group_id, hull_pos + 1), group_id});
+                std::push_heap(heap_.begin(), heap_.end());
+            }
+        }
+        return bound;
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get a multiplier. */
+    inline double multiplier(ResourceId resource_id) const { return multipliers_[resource_id]; }
+
+    /** Get the aggregated capacity. */
+    inline double aggregated_capacity() const { return aggregated_capacity_; }
+
+    /** Get the aggregated weight of an item. */
+    inline double aggregated_weight(
+            GroupId group_id,
+            ItemId item_id) const
+    {
+        return aggregated_weights_[group_offsets_[group_id] + item_id];
+    }
+
+    /** Get the number of items on the upper hull of a group. */
+    inline ItemId number_of_hull_items(GroupId group_id) const { return hull_offsets_[group_id + 1] - hull_offsets_[group_id]; }
+
+    /** Get an item of the upper hull of a group, by increasing aggregated weight. */
+    inline ItemId hull_item_id(
+            GroupId group_id,
+            ItemId hull_pos) const
+    {
+        return hull_item_ids_[hull_offsets_[group_id] + hull_pos];
+    }
+
+    /** Get the item fixed in a group, -1 if the group is free. */
+    inline ItemId fixed_item_id(GroupId group_id) const { return fixed_item_ids_[group_id]; }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Get the slope of the segment of a hull starting at a position. */
+    inline double slope(
+            GroupId group_id,
+            ItemId hull_pos) const
+    {
+        ItemId item_id_1 = hull_item_ids_[hull_pos];
+        ItemId item_id_2 = hull_item_ids_[hull_pos + 1];
+        return (double)(instance_.item(group_id, item_id_2).profit
+                - instance_.item(group_id, item_id_1).profit)
+            / (aggregated_weight(group_id, item_id_2)
+                    - aggregated_weight(group_id, item_id_1));
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Multipliers. */
+    std::vector<double> multipliers_;
+
+    /** Aggregated capacity. */
+    double aggregated_capacity_ = 0;
+
+    /** Tolerance on the aggregated weights, relative to the aggregated capacity. */
+    double tolerance_ = 0;
+
+    /** Offsets of the items of each group in 'aggregated_weights_'. */
+    std::vector<ItemId> group_offsets_;
+
+    /** Aggregated weights of the items. */
+    std::vector<double> aggregated_weights_;
+
+    /** For each item, 'true' iff it fits alone in the capacities. */
+    std::vector<bool> feasible_;
+
+    /** Items of the upper hulls of the groups, by increasing aggregated weight. */
+    std::vector<ItemId> hull_item_ids_;
+
+    /** Offsets of the upper hull of each group in 'hull_item_ids_'. */
+    std::vector<ItemId> hull_offsets_;
+
+    /** For each group, the item fixed, -1 if the group is free. */
+    std::vector<ItemId> fixed_item_ids_;
+
+    /** Heap of the next segment of each group, by slope. */
+    std::vector<std::pair<double, GroupId>> heap_;
+
+    /** Current position in the hull of each group. */
+    std::vector<ItemId> hull_positions_;
+
 };
 
 }
@@ -16,6 +16,7 @@
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
@@ -70,6 +71,98 @@ public:
     /** Get the total profit of the items. */
     Profit total_profit() const { return profit_sum_; }
 
+    /** Get the total capacity of the knapsacks. */
+    Weight total_capacity() const { return total_capacity_; }
+
+    /**
+     * Get the item at a given position when the items are sorted by
+     * non-increasing efficiency (profit / weight).
+     */
+    ItemId sorted_item_id(ItemPos item_pos) const { return sorted_item_ids_[item_pos]; }
+
+    /** Get the position of an item when the items are sorted by efficiency. */
+    ItemPos efficiency_pos(ItemId item_id) const { return efficiency_positions_[item_id]; }
+
+    /** Get the total weight of the 'item_pos' most efficient items. */
+    Weight prefix_weight(ItemPos item_pos) const { return prefix_weights_[item_pos]; }
+
+    /** Get the total profit of the 'item_pos' most efficient items. */
+    Profit prefix_profit(ItemPos item_pos) const { return prefix_profits_[item_pos]; }
+
+    /*
+     * Bounds
+     */
+
+    /**
+     * Compute the surrogate relaxation upper bound.
+     *
+     * With equal multipliers, the surrogate relaxation is a knapsack problem
+     * with the total capacity of the knapsacks. Its Dantzig bound is computed
+     * in O(log n).
+     */
+    Profit surrogate_relaxation_upper_bound() const
+    {
+        return surrogate_relaxation_upper_bound({}, {});
+    }
+
+    /**
+     * Compute the surrogate relaxation upper bound with some items fixed in
+     * or out.
+     *
+     * It runs in O(k log k + log n) where k is the number of fixed items.
+     * It returns -1 if the fixed-in items don't fit in the total capacity.
+     */
+    Profit surrogate_relaxation_upper_bound(
+            const std::vector<ItemId>& fixed_in_item_ids,
+            const std::vector<ItemId>& fixed_out_item_ids) const
+    {
+        Weight capacity = total_capacity();
+        Profit profit = 0;
+        std::vector<ItemPos> fixed_positions;
+        for (ItemId item_id: fixed_in_item_ids) {
+            capacity -= item(item_id).weight;
+            profit += item(item_id).profit;
+            fixed_positions.push_back(efficiency_pos(item_id));
+        }
+        if (capacity < 0)
+            return -1;
+        for (ItemId item_id: fixed_out_item_ids)
+            fixed_positions.push_back(efficiency_pos(item_id));
+        std::sort(fixed_positions.begin(), fixed_positions.end());
+
+        // The fixed items split the sorted items into ranges of free items.
+        // Look for the range containing the critical item.
+        Weight fixed_weight = 0;
+        Profit fixed_profit = 0;
+        ItemPos item_pos_first = 0;
+        for (ItemPos fixed_pos = 0;
+                fixed_pos <= (ItemPos)fixed_positions.size();
+                ++fixed_pos) {
+            ItemPos item_pos_last = (fixed_pos < (ItemPos)fixed_positions.size())?
+                fixed_positions[fixed_pos]:
+                number_of_items();
+            if (prefix_weight(item_pos_last) - fixed_weight > capacity) {
+                ItemPos item_pos_critical = std::upper_bound(
+                        prefix_weights_.begin() + item_pos_first,
+                        prefix_weights_.begin() + item_pos_last + 1,
+                        capacity + fixed_weight) - prefix_weights_.begin() - 1;
+                const Item& item_critical = item(sorted_item_id(item_pos_critical));
+                Weight remaining_capacity = capacity
+                    - (prefix_weight(item_pos_critical) - fixed_weight);
+                return profit
+                    + prefix_profit(item_pos_critical) - fixed_profit
+                    + item_critical.profit * remaining_capacity / item_critical.weight;
+            }
+            if (fixed_pos == (ItemPos)fixed_positions.size())
+                break;
+            const Item& item_fixed = item(sorted_item_id(item_pos_last));
+            fixed_weight += item_fixed.weight;
+            fixed_profit += item_fixed.profit;
+            item_pos_first = item_pos_last + 1;
+        }
+        return profit + prefix_profit(number_of_items()) - fixed_profit;
+    }
+
     /*
      * Outputs
      */
@@ -247,6 +340,21 @@ private:
     /** Profit sum. */
     Profit profit_sum_ = 0;
 
+    /** Total capacity. */
+    Weight total_capacity_ = 0;
+
+    /** Items sorted by non-increasing efficiency. */
+    std::vector<ItemId> sorted_item_ids_;
+
+    /** Position of each item in 'sorted_item_ids_'. */
+    std::vector<ItemPos> efficiency_positions_;
+
+    /** Prefix weights of the items sorted by efficiency. */
+    std::vector<Weight> prefix_weights_;
+
+    /** Prefix profits of the items sorted by efficiency. */
+    std::vector<Profit> prefix_profits_;
+
     friend class InstanceBuilder;
 };
 
@@ -304,6 +412,41 @@ public:
             instance_.profit_sum_ += item.profit;
         }
 
+        // Compute total capacity.
+        instance_.total_capacity_ = 0;
+        for (KnapsackId knapsack_id = 0;
+                knapsack_id < instance_.number_of_knapsacks();
+                ++knapsack_id) {
+            instance_.total_capacity_ += instance_.capacity(knapsack_id);
+        }
+
+        // Sort the items by efficiency.
+        ItemId number_of_items = instance_.number_of_items();
+        instance_.sorted_item_ids_.resize(number_of_items);
+        for (ItemId item_id = 0; item_id < number_of_items; ++item_id)
+            instance_.sorted_item_ids_[item_id] = item_id;
+        std::stable_sort(
+                instance_.sorted_item_ids_.begin(),
+                instance_.sorted_item_ids_.end(),
+                [this](ItemId item_id_1, ItemId item_id_2)
+                {
+                    const Item& item_1 = instance_.item(item_id_1);
+                    const Item& item_2 = instance_.item(item_id_2);
+                    return item_1.profit * item_2.weight > item_2.profit * item_1.weight;
+                });
+        instance_.efficiency_positions_.resize(number_of_items);
+        instance_.prefix_weights_.resize(number_of_items + 1);
+        instance_.prefix_profits_.resize(number_of_items + 1);
+        instance_.prefix_weights_[0] = 0;
+        instance_.prefix_profits_[0] = 0;
+        for (ItemPos item_pos = 0; item_pos < number_of_items; ++item_pos) {
+            ItemId item_id = instance_.sorted_item_ids_[item_pos];
+            const Item& item = instance_.item(item_id);
+            instance_.efficiency_positions_[item_id] = item_pos;
+            instance_.prefix_weights_[item_pos + 1] = instance_.prefix_weights_[item_pos] + item.weight;
+            instance_.prefix_profits_[item_pos + 1] = instance_.prefix_profits_[item_pos] + item.profit;
+        }
+
         return std::move(instance_);
     }
 
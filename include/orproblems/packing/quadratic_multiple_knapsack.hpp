@@ -19,9 +19,11 @@
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 
 namespace orproblems
 {
@@ -34,6 +36,24 @@ using KnapsackId = int64_t;
 using Weight = int64_t;
 using Profit = int64_t;
 
+/**
+ * Enumeration of the storage modes of the profits.
+ *
+ * The profits are stored in the packed lower triangle of the profit matrix,
+ * with the narrowest integer type which can hold all of them.
+ */
+enum class ProfitsStorage
+{
+    /** 16-bit integers. */
+    Int16,
+
+    /** 32-bit integers. */
+    Int32,
+
+    /** 64-bit integers. */
+    Int64,
+};
+
 /**
  * Instance class for a 'quadratic_multiple_knapsack' problem.
  */
@@ -56,16 +76,59 @@ public:
     Weight weight(ItemId item_id) const { return weights_[item_id]; }
 
     /** Get the profit of an item. */
-    Profit profit(ItemId item_id) const { return profits_[item_id][item_id]; }
+    Profit profit(ItemId item_id) const { return profit(item_id, item_id); }
 
     /** Get the profit of two items. */
     Profit profit(
             ItemId item_id_1,
             ItemId item_id_2) const
     {
-        return profits_[std::min(item_id_1, item_id_2)][std::max(item_id_1, item_id_2)];
+        ItemPos pos = profit_index(item_id_1, item_id_2);
+        if (profits_storage_ == ProfitsStorage::Int16) {
+            return profits_int16_[pos];
+        } else if (profits_storage_ == ProfitsStorage::Int32) {
+            return profits_int32_[pos];
+        } else {
+            return profits_[pos];
+        }
+    }
+
+    /** Get the storage mode of the profits. */
+    ProfitsStorage profits_storage() const { return profits_storage_; }
+
+    /**
+     * Get the position of the profit of two items in the packed lower
+     * triangle of the profit matrix.
+     *
+     * The profits of item j with items 0..j are contiguous.
+     */
+    static ItemPos profit_index(
+            ItemId item_id_1,
+            ItemId item_id_2)
+    {
+        if (item_id_1 < item_id_2)
+            std::swap(item_id_1, item_id_2);
+        return item_id_1 * (item_id_1 + 1) / 2 + item_id_2;
     }
 
+    /**
+     * Get the profits of an item with items 0..item_id, if they are stored
+     * as 16-bit integers.
+     */
+    const int16_t* profits_int16(ItemId item_id) const { return profits_int16_.data() + profit_index(item_id, 0); }
+
+    /**
+     * Get the profits of an item with items 0..item_id, if they are stored
+     * as 32-bit integers.
+     */
+    const int32_t* profits_int32(ItemId item_id) const { return profits_int32_.data() + profit_index(item_id, 0); }
+
+    /**
+     * Get the profits of an item with items 0..item_id, if they are stored
+     * as 64-bit integers.
+     */
+    const Profit* profits_int64(ItemId item_id) const { return profits_.data() + profit_index(item_id, 0); }
+
     /** Get the capacity of a knapsack. */
     Weight capacity(KnapsackId knapsack_id) const { return capacities_[knapsack_id]; }
 
@@ -259,8 +322,17 @@ private:
     /** Weights. */
     std::vector<Weight> weights_;
 
-    /** Profits. */
-    std::vector<std::vector<Profit>> profits_;
+    /** Storage mode of the profits. */
+    ProfitsStorage profits_storage_ = ProfitsStorage::Int64;
+
+    /** Profits, if they are stored as 64-bit integers. */
+    std::vector<Profit> profits_;
+
+    /** Profits, if they are stored as 32-bit integers. */
+    std::vector<int32_t> profits_int32_;
+
+    /** Profits, if they are stored as 16-bit integers. */
+    std::vector<int16_t> profits_int16_;
 
     /** Capacities. */
     std::vector<Weight> capacities_;
@@ -286,7 +358,7 @@ public:
     void add_item(Weight weight)
     {
         instance_.weights_.push_back(weight);
-        instance_.profits_.push_back(std::vector<Profit>(instance_.weights_.size()));
+        profits_.resize(profits_.size() + instance_.weights_.size(), 0);
     }
 
     /** Set the weight of an item. */
@@ -302,7 +374,7 @@ public:
             ItemId item_id,
             Profit profit)
     {
-        instance_.profits_[item_id][item_id] = profit;
+        profits_[Instance::profit_index(item_id, item_id)] = profit;
     }
 
     /** Set the profit of packing two items. */
@@ -311,7 +383,7 @@ public:
             ItemId item_id_2,
             Profit profit)
     {
-        instance_.profits_[std::min(item_id_1, item_id_2)][std::max(item_id_1, item_id_2)] = profit;
+        profits_[Instance::profit_index(item_id_1, item_id_2)] = profit;
     }
 
     /** Build an instance from a file. */
@@ -339,6 +411,30 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        // Select the storage mode of the profits.
+        Profit profit_min = 0;
+        Profit profit_max = 0;
+        for (Profit profit: profits_) {
+            profit_min = std::min(profit_min, profit);
+            profit_max = std::max(profit_max, profit);
+        }
+        instance_.profits_.clear();
+        instance_.profits_int32_.clear();
+        instance_.profits_int16_.clear();
+        if (profit_min >= std::numeric_limits<int16_t>::min()
+                && profit_max <= std::numeric_limits<int16_t>::max()) {
+            instance_.profits_storage_ = ProfitsStorage::Int16;
+            instance_.profits_int16_.assign(profits_.begin(), profits_.end());
+        } else if (profit_min >= std::numeric_limits<int32_t>::min()
+                && profit_max <= std::numeric_limits<int32_t>::max()) {
+            instance_.profits_storage_ = ProfitsStorage::Int32;
+            instance_.profits_int32_.assign(profits_.begin(), profits_.end());
+        } else {
+            instance_.profits_storage_ = ProfitsStorage::Int64;
+            instance_.profits_ = std::move(profits_);
+        }
+        profits_.clear();
+
         return std::move(instance_);
     }
 
@@ -399,6 +495,276 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Profits, in the packed lower triangle of the profit matrix. */
+    std::vector<Profit> profits_;
+
+};
+
+/**
+ * Evaluator of the moves of a local search for a
+ * 'quadratic_multiple_knapsack' problem.
+ *
+ * It maintains the knapsack of each item and a contribution table, which
+ * contains for each knapsack k and each item j the sum of the profits of the
+ * pairs formed by j and the other items of k.
+ *
+ * The profit difference and the feasibility of inserting, removing,
+ * transferring or swapping items are computed in O(1). Applying a move
+ * updates the contribution table with one sweep of the profits of each moved
+ * item, in O(n). The profits of an item with the items of smaller ids are
+ * contiguous in the instance, so this part of the sweep gets vectorized.
+ */
+class KnapsacksEvaluator
+{
+
+public:
+
+    /** Structure for the evaluation of a move. */
+    struct MoveEvaluation
+    {
+        /** Difference of profit. */
+        Profit profit_difference;
+
+        /** 'true' iff the knapsacks don't exceed their capacities after the move. */
+        bool feasible;
+    };
+
+    /** Constructor; initially, no item is packed. */
+    KnapsacksEvaluator(const Instance& instance):
+        instance_(instance),
+        knapsack_ids_(instance.number_of_items(), -1),
+        weights_(instance.number_of_knapsacks(), 0),
+        contributions_(instance.number_of_knapsacks() * instance.number_of_items(), 0)
+    {
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the knapsack of an item, -1 if it is not packed. */
+    inline KnapsackId knapsack_id(ItemId item_id) const { return knapsack_ids_[item_id]; }
+
+    /** Get the weight of a knapsack. */
+    inline Weight weight(KnapsackId knapsack_id) const { return weights_[knapsack_id]; }
+
+    /** Get the total profit. */
+    inline Profit profit() const { return profit_; }
+
+    /**
+     * Get the sum of the profits of the pairs formed by an item and the other
+     * items of a knapsack.
+     */
+    inline Profit contribution(
+            ItemId item_id,
+            KnapsackId knapsack_id) const
+    {
+        return contributions_[knapsack_id * instance_.number_of_items() + item_id];
+    }
+
+    /*
+     * Evaluate moves
+     */
+
+    /** Evaluate the insertion of an unpacked item into a knapsack. */
+    inline MoveEvaluation insertion(
+            ItemId item_id,
+            KnapsackId knapsack_id) const
+    {
+        return {
+            instance_.profit(item_id) + contribution(item_id, knapsack_id),
+            weight(knapsack_id) + instance_.weight(item_id) <= instance_.capacity(knapsack_id)};
+    }
+
+    /** Evaluate the removal of a packed item. */
+    inline MoveEvaluation removal(ItemId item_id) const
+    {
+        return {
+            -instance_.profit(item_id) - contribution(item_id, knapsack_id(item_id)),
+            true};
+    }
+
+    /**
+     * Evaluate the transfer of an item into another knapsack.
+     *
+     * Both the initial knapsack of the item and the new one may be -1,
+     * meaning that the item is not packed.
+     */
+    inline MoveEvaluation transfer(
+            ItemId item_id,
+            KnapsackId knapsack_id) const
+    {
+        KnapsackId knapsack_id_old = this->knapsack_id(item_id);
+        if (knapsack_id == knapsack_id_old)
+            return {0, true};
+        Profit profit_difference = 0;
+        bool feasible = true;
+        if (knapsack_id_old != -1)
+            profit_difference -= instance_.profit(item_id) + contribution(item_id, knapsack_id_old);
+        if (knapsack_id != -1) {
+            MoveEvaluation move_evaluation = insertion(item_id, knapsack_id);
+            profit_difference += move_evaluation.profit_difference;
+            feasible = move_evaluation.feasible;
+        }
+        return {profit_difference, feasible};
+    }
+
+    /**
+     * Evaluate the swap of the knapsacks of two items.
+     *
+     * One of the items may not be packed.
+     */
+    inline MoveEvaluation swap(
+            ItemId item_id_1,
+            ItemId item_id_2) const
+    {
+        KnapsackId knapsack_id_1 = knapsack_id(item_id_1);
+        KnapsackId knapsack_id_2 = knapsack_id(item_id_2);
+        if (knapsack_id_1 == knapsack_id_2)
+            return {0, true};
+        Weight weight_1 = instance_.weight(item_id_1);
+        Weight weight_2 = instance_.weight(item_id_2);
+        Profit profit_1 = instance_.profit(item_id_1);
+        Profit profit_2 = instance_.profit(item_id_2);
+        Profit profit_12 = instance_.profit(item_id_1, item_id_2);
+        Profit profit_difference = 0;
+        bool feasible = true;
+        if (knapsack_id_1 != -1) {
+            profit_difference
+                += profit_2 + contribution(item_id_2, knapsack_id_1) - profit_12
+                - profit_1 - contribution(item_id_1, knapsack_id_1);
+            feasible &= (weight(knapsack_id_1) - weight_1 + weight_2
+                    <= instance_.capacity(knapsack_id_1));
+        }
+        if (knapsack_id_2 != -1) {
+            profit_difference
+                += profit_1 + contribution(item_id_1, knapsack_id_2) - profit_12
+                - profit_2 - contribution(item_id_2, knapsack_id_2);
+            feasible &= (weight(knapsack_id_2) - weight_2 + weight_1
+                    <= instance_.capacity(knapsack_id_2));
+        }
+        return {profit_difference, feasible};
+    }
+
+    /*
+     * Apply moves
+     */
+
+    /**
+     * Move an item into a knapsack.
+     *
+     * Both the initial knapsack of the item and the new one may be -1,
+     * meaning that the item is not packed.
+     */
+    void apply_transfer(
+            ItemId item_id,
+            KnapsackId knapsack_id)
+    {
+        KnapsackId knapsack_id_old = this->knapsack_id(item_id);
+        if (knapsack_id == knapsack_id_old)
+            return;
+        profit_ += transfer(item_id, knapsack_id).profit_difference;
+        if (knapsack_id_old != -1)
+            weights_[knapsack_id_old] -= instance_.weight(item_id);
+        if (knapsack_id != -1)
+            weights_[knapsack_id] += instance_.weight(item_id);
+        knapsack_ids_[item_id] = knapsack_id;
+
+        if (instance_.profits_storage() == ProfitsStorage::Int16) {
+            update_contributions(instance_.profits_int16(0), item_id, knapsack_id_old, knapsack_id);
+        } else if (instance_.profits_storage() == ProfitsStorage::Int32) {
+            update_contributions(instance_.profits_int32(0), item_id, knapsack_id_old, knapsack_id);
+        } else {
+            update_contributions(instance_.profits_int64(0), item_id, knapsack_id_old, knapsack_id);
+        }
+    }
+
+    /** Insert an unpacked item into a knapsack. */
+    void apply_insertion(
+            ItemId item_id,
+            KnapsackId knapsack_id)
+    {
+        apply_transfer(item_id, knapsack_id);
+    }
+
+    /** Remove a packed item. */
+    void apply_removal(ItemId item_id) { apply_transfer(item_id, -1); }
+
+    /** Swap the knapsacks of two items. */
+    void apply_swap(
+            ItemId item_id_1,
+            ItemId item_id_2)
+    {
+        KnapsackId knapsack_id_1 = knapsack_id(item_id_1);
+        KnapsackId knapsack_id_2 = knapsack_id(item_id_2);
+        apply_transfer(item_id_1, knapsack_id_2);
+        apply_transfer(item_id_2, knapsack_id_1);
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /**
+     * Update the contributions of the old and new knapsacks of an item.
+     *
+     * 'profits' points to the packed lower triangle of the profit matrix.
+     */
+    template <typename ProfitType>
+    void update_contributions(
+            const ProfitType* profits,
+            ItemId item_id,
+            KnapsackId knapsack_id_old,
+            KnapsackId knapsack_id_new)
+    {
+        ItemId number_of_items = instance_.number_of_items();
+        const ProfitType* row = profits + Instance::profit_index(item_id, 0);
+        Profit* contributions_old = (knapsack_id_old == -1)? nullptr:
+            contributions_.data() + knapsack_id_old * number_of_items;
+        Profit* contributions_new = (knapsack_id_new == -1)? nullptr:
+            contributions_.data() + knapsack_id_new * number_of_items;
+
+        // Items with a smaller id; the profits are contiguous.
+        if (contributions_old != nullptr)
+            for (ItemId item_id_2 = 0; item_id_2 < item_id; ++item_id_2)
+                contributions_old[item_id_2] -= row[item_id_2];
+        if (contributions_new != nullptr)
+            for (ItemId item_id_2 = 0; item_id_2 < item_id; ++item_id_2)
+                contributions_new[item_id_2] += row[item_id_2];
+
+        // Items with a larger id; the profits are in a column.
+        for (ItemId item_id_2 = item_id + 1;
+                item_id_2 < number_of_items;
+                ++item_id_2) {
+            Profit profit = profits[Instance::profit_index(item_id_2, item_id)];
+            if (contributions_old != nullptr)
+                contributions_old[item_id_2] -= profit;
+            if (contributions_new != nullptr)
+                contributions_new[item_id_2] += profit;
+        }
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Knapsack of each item, -1 if it is not packed. */
+    std::vector<KnapsackId> knapsack_ids_;
+
+    /** Weight of each knapsack. */
+    std::vector<Weight> weights_;
+
+    /** Total profit. */
+    Profit profit_ = 0;
+
+    /** Contribution table, laid out [knapsack][item]. */
+    std::vector<Profit> contributions_;
+
 };
 
 }
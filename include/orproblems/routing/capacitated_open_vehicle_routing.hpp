@@ -420,5 +420,445 @@ private:
 
 };
 
+/**
+ * Incremental evaluator for the routes of a solution of a
+ * 'capacitated_open_vehicle_routing' problem.
+ *
+ * Inside the evaluator, position 0 of each route is the depot and positions
+ * 1..k are its customers. Since routes do not return to the depot, the last
+ * customer of a route is a free end.
+ *
+ * For each position, the evaluator stores the length and the load of the
+ * path from the depot, the length of the path until the end of the route,
+ * and the length of the reversed path from the depot. Thus, the length and
+ * the load of any concatenation of route segments, reversed or not, are
+ * computed in O(1) per segment.
+ */
+class RoutesEvaluator
+{
+
+public:
+
+    /** Structure for a segment of a route. */
+    struct Segment
+    {
+        /** Route. */
+        RouteId route_id;
+
+        /** Position of the first location of the segment. */
+        LocationPos pos_first;
+
+        /**
+         * Position of the last location of the segment.
+         *
+         * If 'pos_last < pos_first', then the segment is empty.
+         */
+        LocationPos pos_last;
+
+        /** 'true' iff the segment is traversed backward. */
+        bool reversed = false;
+    };
+
+    /** Structure for the value of a route. */
+    struct RouteValue
+    {
+        /** Length. */
+        Distance length = 0;
+
+        /** Load. */
+        Demand load = 0;
+
+        /** 'true' iff the route contains at least one customer. */
+        bool used = false;
+    };
+
+    /** Structure for the evaluation of a move. */
+    struct MoveEvaluation
+    {
+        /** Difference of total length. */
+        Distance length_difference = 0;
+
+        /** Difference of number of non-empty routes. */
+        RouteId number_of_routes_difference = 0;
+
+        /**
+         * 'true' iff the modified routes satisfy the capacity and maximum
+         * route length constraints and the number of non-empty routes does
+         * not exceed the number of vehicles.
+         */
+        bool feasible = false;
+    };
+
+    /** Constructor. */
+    RoutesEvaluator(
+            const Instance& instance,
+            RouteId number_of_routes):
+        instance_(instance),
+        routes_(number_of_routes)
+    {
+        for (RouteId route_id = 0; route_id < number_of_routes; ++route_id)
+            set_route(route_id, {});
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of routes. */
+    inline RouteId number_of_routes() const { return routes_.size(); }
+
+    /** Get the number of non-empty routes. */
+    inline RouteId number_of_non_empty_routes() const { return number_of_non_empty_routes_; }
+
+    /** Get the number of customers of a route. */
+    inline LocationPos route_number_of_customers(RouteId route_id) const { return routes_[route_id].locations.size() - 1; }
+
+    /** Get the location at a given position of a route. */
+    inline LocationId location(RouteId route_id, LocationPos pos) const { return routes_[route_id].locations[pos]; }
+
+    /** Get the length of the path from the depot to a given position. */
+    inline Distance prefix_length(RouteId route_id, LocationPos pos) const { return routes_[route_id].prefix_lengths[pos]; }
+
+    /** Get the load of the path from the depot to a given position. */
+    inline Demand prefix_load(RouteId route_id, LocationPos pos) const { return routes_[route_id].prefix_loads[pos]; }
+
+    /** Get the length of the path from a given position to the end of the route. */
+    inline Distance suffix_length(RouteId route_id, LocationPos pos) const { return routes_[route_id].suffix_lengths[pos]; }
+
+    /** Get the length of a route. */
+    inline Distance route_length(RouteId route_id) const { return routes_[route_id].suffix_lengths[0]; }
+
+    /** Get the load of a route. */
+    inline Demand route_load(RouteId route_id) const { return routes_[route_id].prefix_loads.back(); }
+
+    /** Get the total length of the routes. */
+    inline Distance total_length() const { return total_length_; }
+
+    /** Return 'true' iff a route satisfies the capacity and length constraints. */
+    inline bool feasible(const RouteValue& route_value) const
+    {
+        return route_value.load <= instance_.capacity()
+            && !(route_value.length > instance_.maximum_route_length());
+    }
+
+    /*
+     * Setters
+     */
+
+    /**
+     * Set the customers of a route.
+     *
+     * This method runs in O(k) where k is the number of customers of the
+     * route.
+     */
+    void set_route(
+            RouteId route_id,
+            const std::vector<LocationId>& customers)
+    {
+        const travelingsalesmansolver::Distances& distances = instance_.distances();
+        RouteData& route = routes_[route_id];
+        if (route.locations.size() > 1) {
+            number_of_non_empty_routes_--;
+            total_length_ -= route.suffix_lengths[0];
+        }
+
+        LocationPos route_size = customers.size() + 1;
+        route.locations.resize(route_size);
+        route.prefix_lengths.resize(route_size);
+        route.reversed_prefix_lengths.resize(route_size);
+        route.prefix_loads.resize(route_size);
+        route.suffix_lengths.resize(route_size);
+
+        route.locations[0] = 0;
+        route.prefix_lengths[0] = 0;
+        route.reversed_prefix_lengths[0] = 0;
+        route.prefix_loads[0] = 0;
+        for (LocationPos pos = 1; pos < route_size; ++pos) {
+            LocationId location_id_prev = route.locations[pos - 1];
+            LocationId location_id = customers[pos - 1];
+            route.locations[pos] = location_id;
+            route.prefix_lengths[pos] = route.prefix_lengths[pos - 1]
+                + distances.distance(location_id_prev, location_id);
+            route.reversed_prefix_lengths[pos] = route.reversed_prefix_lengths[pos - 1]
+                + distances.distance(location_id, location_id_prev);
+            route.prefix_loads[pos] = route.prefix_loads[pos - 1]
+                + instance_.demand(location_id);
+        }
+        route.suffix_lengths[route_size - 1] = 0;
+        for (LocationPos pos = route_size - 2; pos >= 0; --pos) {
+            route.suffix_lengths[pos] = route.suffix_lengths[pos + 1]
+                + distances.distance(route.locations[pos], route.locations[pos + 1]);
+        }
+
+        if (route_size > 1) {
+            number_of_non_empty_routes_++;
+            total_length_ += route.suffix_lengths[0];
+        }
+    }
+
+    /*
+     * Evaluators
+     */
+
+    /**
+     * Evaluate the route made of a concatenation of segments.
+     *
+     * The first non-empty segment must start at the depot and must not be
+     * reversed. The last location of the last non-empty segment is the free
+     * end of the route, so no return arc is counted.
+     *
+     * This method runs in O(s) where s is the number of segments.
+     */
+    RouteValue concatenate(std::initializer_list<Segment> segments) const
+    {
+        const travelingsalesmansolver::Distances& distances = instance_.distances();
+        RouteValue route_value;
+        LocationId location_id_prev = -1;
+        for (const Segment& segment: segments) {
+            if (segment.pos_last < segment.pos_first)
+                continue;
+            const RouteData& route = routes_[segment.route_id];
+            LocationId location_id_first = route.locations[segment.pos_first];
+            LocationId location_id_last = route.locations[segment.pos_last];
+            if (segment.reversed)
+                std::swap(location_id_first, location_id_last);
+
+            if (location_id_prev != -1) {
+                route_value.length += distances.distance(
+                        location_id_prev,
+                        location_id_first);
+            }
+            if (!segment.reversed) {
+                route_value.length
+                    += route.prefix_lengths[segment.pos_last]
+                    - route.prefix_lengths[segment.pos_first];
+            } else {
+                route_value.length
+                    += route.reversed_prefix_lengths[segment.pos_last]
+                    - route.reversed_prefix_lengths[segment.pos_first];
+            }
+            route_value.load += route.prefix_loads[segment.pos_last];
+            if (segment.pos_first > 0)
+                route_value.load -= route.prefix_loads[segment.pos_first - 1];
+            if (location_id_last != 0)
+                route_value.used = true;
+            location_id_prev = location_id_last;
+        }
+        return route_value;
+    }
+
+    /**
+     * Evaluate a 2-opt* move.
+     *
+     * The tails of the two routes after positions 'pos_1' and 'pos_2' are
+     * exchanged.
+     */
+    MoveEvaluation two_opt_star(
+            RouteId route_id_1,
+            LocationPos pos_1,
+            RouteId route_id_2,
+            LocationPos pos_2) const
+    {
+        LocationPos pos_end_1 = route_number_of_customers(route_id_1);
+        LocationPos pos_end_2 = route_number_of_customers(route_id_2);
+        RouteValue route_value_1 = concatenate({
+                {route_id_1, 0, pos_1},
+                {route_id_2, pos_2 + 1, pos_end_2}});
+        RouteValue route_value_2 = concatenate({
+                {route_id_2, 0, pos_2},
+                {route_id_1, pos_1 + 1, pos_end_1}});
+        return evaluate(
+                route_id_1, route_value_1,
+                route_id_2, route_value_2);
+    }
+
+    /**
+     * Evaluate a 2-opt move.
+     *
+     * The segment between positions 'pos_first' and 'pos_last' is reversed.
+     * If 'pos_last' is the last position of the route, then only the arc
+     * entering the segment changes.
+     */
+    MoveEvaluation two_opt(
+            RouteId route_id,
+            LocationPos pos_first,
+            LocationPos pos_last) const
+    {
+        LocationPos pos_end = route_number_of_customers(route_id);
+        RouteValue route_value = concatenate({
+                {route_id, 0, pos_first - 1},
+                {route_id, pos_first, pos_last, true},
+                {route_id, pos_last + 1, pos_end}});
+        return evaluate(route_id, route_value);
+    }
+
+    /**
+     * Evaluate a relocate move.
+     *
+     * The segment between positions 'pos_first' and 'pos_last' of route
+     * 'route_id_1' is moved after position 'pos' of route 'route_id_2',
+     * possibly reversed. If both routes are the same, 'pos' must not be
+     * inside the segment.
+     */
+    MoveEvaluation relocate(
+            RouteId route_id_1,
+            LocationPos pos_first,
+            LocationPos pos_last,
+            RouteId route_id_2,
+            LocationPos pos,
+            bool reversed = false) const
+    {
+        LocationPos pos_end_1 = route_number_of_customers(route_id_1);
+        if (route_id_1 == route_id_2) {
+            RouteValue route_value;
+            if (pos < pos_first) {
+                route_value = concatenate({
+                        {route_id_1, 0, pos},
+                        {route_id_1, pos_first, pos_last, reversed},
+                        {route_id_1, pos + 1, pos_first - 1},
+                        {route_id_1, pos_last + 1, pos_end_1}});
+            } else {
+                route_value = concatenate({
+                        {route_id_1, 0, pos_first - 1},
+                        {route_id_1, pos_last + 1, pos},
+                        {route_id_1, pos_first, pos_last, reversed},
+                        {route_id_1, pos + 1, pos_end_1}});
+            }
+            return evaluate(route_id_1, route_value);
+        }
+
+        LocationPos pos_end_2 = route_number_of_customers(route_id_2);
+        RouteValue route_value_1 = concatenate({
+                {route_id_1, 0, pos_first - 1},
+                {route_id_1, pos_last + 1, pos_end_1}});
+        RouteValue route_value_2 = concatenate({
+                {route_id_2, 0, pos},
+                {route_id_1, pos_first, pos_last, reversed},
+                {route_id_2, pos + 1, pos_end_2}});
+        return evaluate(
+                route_id_1, route_value_1,
+                route_id_2, route_value_2);
+    }
+
+    /**
+     * Evaluate a cross-exchange move.
+     *
+     * The segment between positions 'pos_first_1' and 'pos_last_1' of route
+     * 'route_id_1' and the segment between positions 'pos_first_2' and
+     * 'pos_last_2' of route 'route_id_2' are exchanged, each one possibly
+     * reversed. The routes must be different.
+     */
+    MoveEvaluation cross_exchange(
+            RouteId route_id_1,
+            LocationPos pos_first_1,
+            LocationPos pos_last_1,
+            RouteId route_id_2,
+            LocationPos pos_first_2,
+            LocationPos pos_last_2,
+            bool reversed_1 = false,
+            bool reversed_2 = false) const
+    {
+        LocationPos pos_end_1 = route_number_of_customers(route_id_1);
+        LocationPos pos_end_2 = route_number_of_customers(route_id_2);
+        RouteValue route_value_1 = concatenate({
+                {route_id_1, 0, pos_first_1 - 1},
+                {route_id_2, pos_first_2, pos_last_2, reversed_2},
+                {route_id_1, pos_last_1 + 1, pos_end_1}});
+        RouteValue route_value_2 = concatenate({
+                {route_id_2, 0, pos_first_2 - 1},
+                {route_id_1, pos_first_1, pos_last_1, reversed_1},
+                {route_id_2, pos_last_2 + 1, pos_end_2}});
+        return evaluate(
+                route_id_1, route_value_1,
+                route_id_2, route_value_2);
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Evaluate the replacement of a route. */
+    MoveEvaluation evaluate(
+            RouteId route_id,
+            const RouteValue& route_value) const
+    {
+        MoveEvaluation move_evaluation;
+        move_evaluation.length_difference
+            = route_value.length - route_length(route_id);
+        move_evaluation.number_of_routes_difference
+            = (RouteId)route_value.used
+            - (RouteId)(route_number_of_customers(route_id) > 0);
+        move_evaluation.feasible
+            = feasible(route_value)
+            && (number_of_non_empty_routes()
+                    + move_evaluation.number_of_routes_difference
+                    <= instance_.number_of_vehicles());
+        return move_evaluation;
+    }
+
+    /** Evaluate the replacement of two different routes. */
+    MoveEvaluation evaluate(
+            RouteId route_id_1,
+            const RouteValue& route_value_1,
+            RouteId route_id_2,
+            const RouteValue& route_value_2) const
+    {
+        MoveEvaluation move_evaluation;
+        move_evaluation.length_difference
+            = route_value_1.length - route_length(route_id_1)
+            + route_value_2.length - route_length(route_id_2);
+        move_evaluation.number_of_routes_difference
+            = (RouteId)route_value_1.used
+            - (RouteId)(route_number_of_customers(route_id_1) > 0)
+            + (RouteId)route_value_2.used
+            - (RouteId)(route_number_of_customers(route_id_2) > 0);
+        move_evaluation.feasible
+            = feasible(route_value_1)
+            && feasible(route_value_2)
+            && (number_of_non_empty_routes()
+                    + move_evaluation.number_of_routes_difference
+                    <= instance_.number_of_vehicles());
+        return move_evaluation;
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Structure for the data of a route. */
+    struct RouteData
+    {
+        /** Locations; the first one is the depot. */
+        std::vector<LocationId> locations;
+
+        /** Length of the path from the depot to each position. */
+        std::vector<Distance> prefix_lengths;
+
+        /** Length of the reversed path from each position to the depot. */
+        std::vector<Distance> reversed_prefix_lengths;
+
+        /** Load of the path from the depot to each position. */
+        std::vector<Demand> prefix_loads;
+
+        /** Length of the path from each position to the end of the route. */
+        std::vector<Distance> suffix_lengths;
+    };
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Routes. */
+    std::vector<RouteData> routes_;
+
+    /** Number of non-empty routes. */
+    RouteId number_of_non_empty_routes_ = 0;
+
+    /** Total length. */
+    Distance total_length_ = 0;
+
+};
+
 }
 }
@@ -34,6 +34,8 @@
 #include <fstream>
 #include <memory>
 #include <iomanip>
+#include <algorithm>
+#include <deque>
 
 namespace orproblems
 {
@@ -97,10 +99,29 @@ public:
     const VehicleType& vehicle_type(VehicleTypeId vehicle_type_id) const { return vehicle_types_[vehicle_type_id]; }
 
     /** Get the number of vehicle. */
-    RouteId number_of_vehicles() const { return vehicle_type_ids_.size(); }
+    RouteId number_of_vehicles() const { return (fleet_vehicle_pos_.empty())? 0: fleet_vehicle_pos_.back(); }
 
-    /** Get the type of a vehicle. */
-    VehicleTypeId vehicle_type_id(RouteId vehicle_pos) const { return vehicle_type_ids_[vehicle_pos]; }
+    /**
+     * Get the fleet.
+     *
+     * The fleet is given as a list of pairs (vehicle type, number of
+     * vehicles), containing only the vehicle types with at least one vehicle.
+     */
+    const std::vector<std::pair<VehicleTypeId, RouteId>>& fleet() const { return fleet_; }
+
+    /**
+     * Get the type of a vehicle.
+     *
+     * This method runs in O(log m) where m is the number of vehicle types.
+     */
+    VehicleTypeId vehicle_type_id(RouteId vehicle_pos) const
+    {
+        auto it = std::upper_bound(
+                fleet_vehicle_pos_.begin(),
+                fleet_vehicle_pos_.end(),
+                vehicle_pos);
+        return fleet_[std::distance(fleet_vehicle_pos_.begin(), it)].first;
+    }
 
     /*
      * Outputs
@@ -349,8 +370,14 @@ private:
     /** Total demand. */
     Demand total_demand_ = 0;
 
-    /** Vehicle type ids. */
-    std::vector<VehicleTypeId> vehicle_type_ids_;
+    /** Fleet, as pairs (vehicle type, number of vehicles). */
+    std::vector<std::pair<VehicleTypeId, RouteId>> fleet_;
+
+    /**
+     * For each element of the fleet, the position of the first vehicle of
+     * the next element.
+     */
+    std::vector<RouteId> fleet_vehicle_pos_;
 
     friend class InstanceBuilder;
 };
@@ -462,7 +489,10 @@ public:
             instance_.total_demand_ += instance_.demand(location_id);
         }
 
-        // Compute vehicle_type_ids_.
+        // Compute fleet.
+        instance_.fleet_.clear();
+        instance_.fleet_vehicle_pos_.clear();
+        RouteId vehicle_pos = 0;
         for (VehicleTypeId vehicle_type_id = 0;
                 vehicle_type_id < instance_.number_of_vehicle_types();
                 ++vehicle_type_id) {
@@ -470,11 +500,12 @@ public:
                 instance_.vehicle_types_[vehicle_type_id].number_of_vehicles
                     = instance_.number_of_locations();
             }
-            for (RouteId vehicle_pos = 0;
-                    vehicle_pos < instance_.vehicle_type(vehicle_type_id).number_of_vehicles;
-                    ++vehicle_pos) {
-                instance_.vehicle_type_ids_.push_back(vehicle_type_id);
-            }
+            RouteId number_of_vehicles = instance_.vehicle_type(vehicle_type_id).number_of_vehicles;
+            if (number_of_vehicles == 0)
+                continue;
+            vehicle_pos += number_of_vehicles;
+            instance_.fleet_.push_back({vehicle_type_id, number_of_vehicles});
+            instance_.fleet_vehicle_pos_.push_back(vehicle_pos);
         }
 
         return std::move(instance_);
@@ -544,5 +575,357 @@ private:
 
 };
 
+/**
+ * Split algorithm for a 'heterogeneous_fleet_vehicle_routing' problem.
+ *
+ * Given a giant tour visiting all customers, it computes an optimal partition
+ * of the giant tour into routes, and an optimal assignment of vehicle types to
+ * these routes, such that the capacity of each vehicle is satisfied and the
+ * number of vehicles of each type is not exceeded.
+ *
+ * The route serving customers at positions i..j-1 of the giant tour of a
+ * vehicle of type k costs
+ *     fₖ + rₖ (d(0, tᵢ) - D[i + 1] + D[j] + d(tⱼ₋₁, 0))
+ * where D is the prefix length of the giant tour. Thus, the cost is separable
+ * in i and j, and for a fixed vehicle type, the best predecessor of j is the
+ * minimum over a sliding window defined by the capacity. It is maintained
+ * with a monotone queue for each vehicle type.
+ *
+ * When the fleet size constraints are not binding, this yields an optimal
+ * split in O(n m) where m is the number of vehicle types. Otherwise, a label
+ * setting algorithm with resource vectors is used to enforce the number of
+ * vehicles of each type, which runs in O(n m B L) where B is the maximum
+ * number of customers in a route and L the number of non-dominated labels
+ * per position.
+ */
+class SplitEvaluator
+{
+
+public:
+
+    /** Structure for a route of the output of the split. */
+    struct Route
+    {
+        /** Vehicle type. */
+        VehicleTypeId vehicle_type_id;
+
+        /** Position of the first customer of the route in the giant tour. */
+        LocationPos pos_first;
+
+        /** Position of the last customer of the route in the giant tour. */
+        LocationPos pos_last;
+    };
+
+    /** Structure for the output of the split. */
+    struct Output
+    {
+        /** 'true' iff a feasible split has been found. */
+        bool feasible = false;
+
+        /** Cost. */
+        Cost cost = std::numeric_limits<Cost>::max();
+
+        /** Routes. */
+        std::vector<Route> routes;
+    };
+
+    /** Constructor. */
+    SplitEvaluator(const Instance& instance):
+        instance_(instance)
+    {
+        for (const auto& fleet_element: instance.fleet()) {
+            const VehicleType& vehicle_type = instance.vehicle_type(fleet_element.first);
+            if (maximum_capacity_ < vehicle_type.capacity)
+                maximum_capacity_ = vehicle_type.capacity;
+        }
+    }
+
+    /**
+     * Split a giant tour.
+     *
+     * The giant tour contains each customer once and does not contain the
+     * depot.
+     */
+    Output split(const std::vector<LocationId>& giant_tour)
+    {
+        compute_prefixes(giant_tour);
+        Output output = split_unlimited();
+        if (!output.feasible)
+            return output;
+
+        // Check fleet size constraints.
+        std::vector<RouteId> number_of_vehicles(instance_.number_of_vehicle_types(), 0);
+        bool fleet_feasible = true;
+        for (const Route& route: output.routes) {
+            number_of_vehicles[route.vehicle_type_id]++;
+            if (number_of_vehicles[route.vehicle_type_id]
+                    > instance_.vehicle_type(route.vehicle_type_id).number_of_vehicles) {
+                fleet_feasible = false;
+            }
+        }
+        if (fleet_feasible)
+            return output;
+
+        return split_limited();
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Compute the prefix loads and lengths of a giant tour. */
+    void compute_prefixes(const std::vector<LocationId>& giant_tour)
+    {
+        const travelingsalesmansolver::Distances& distances = instance_.distances();
+        LocationPos n = giant_tour.size();
+        giant_tour_ = &giant_tour;
+        loads_.resize(n + 1);
+        head_costs_.resize(n + 1);
+        tail_costs_.resize(n + 1);
+        lengths_.resize(n + 1);
+        loads_[0] = 0;
+        lengths_[0] = 0;
+        for (LocationPos pos = 0; pos < n; ++pos) {
+            loads_[pos + 1] = loads_[pos] + instance_.demand(giant_tour[pos]);
+            lengths_[pos + 1] = (pos == 0)? 0:
+                lengths_[pos] + distances.distance(giant_tour[pos - 1], giant_tour[pos]);
+        }
+        for (LocationPos pos = 0; pos < n; ++pos)
+            head_costs_[pos] = distances.distance(0, giant_tour[pos]) - lengths_[pos + 1];
+        for (LocationPos pos = 1; pos <= n; ++pos)
+            tail_costs_[pos] = lengths_[pos] + distances.distance(giant_tour[pos - 1], 0);
+    }
+
+    /** Split ignoring the fleet size constraints. */
+    Output split_unlimited()
+    {
+        LocationPos n = giant_tour_->size();
+        const auto& fleet = instance_.fleet();
+        values_.assign(n + 1, std::numeric_limits<Cost>::max());
+        predecessors_.assign(n + 1, -1);
+        predecessor_vehicle_type_ids_.assign(n + 1, -1);
+        queues_.resize(fleet.size());
+        for (auto& queue: queues_)
+            queue.clear();
+
+        values_[0] = 0;
+        for (LocationPos pos = 1; pos <= n; ++pos) {
+            for (VehicleTypeId fleet_pos = 0;
+                    fleet_pos < (VehicleTypeId)fleet.size();
+                    ++fleet_pos) {
+                VehicleTypeId vehicle_type_id = fleet[fleet_pos].first;
+                const VehicleType& vehicle_type = instance_.vehicle_type(vehicle_type_id);
+                std::deque<LocationPos>& queue = queues_[fleet_pos];
+
+                // Add position 'pos - 1' to the queue.
+                if (values_[pos - 1] != std::numeric_limits<Cost>::max()) {
+                    Cost value = values_[pos - 1]
+                        + vehicle_type.variable_cost * head_costs_[pos - 1];
+                    while (!queue.empty()
+                            && values_[queue.back()]
+                            + vehicle_type.variable_cost * head_costs_[queue.back()]
+                            >= value) {
+                        queue.pop_back();
+                    }
+                    queue.push_back(pos - 1);
+                }
+
+                // Remove the positions which violate the capacity.
+                while (!queue.empty()
+                        && loads_[pos] - loads_[queue.front()] > vehicle_type.capacity) {
+                    queue.pop_front();
+                }
+                if (queue.empty())
+                    continue;
+
+                LocationPos pos_prev = queue.front();
+                Cost value = values_[pos_prev]
+                    + vehicle_type.fixed_cost
+                    + vehicle_type.variable_cost
+                    * (head_costs_[pos_prev] + tail_costs_[pos]);
+                if (values_[pos] > value) {
+                    values_[pos] = value;
+                    predecessors_[pos] = pos_prev;
+                    predecessor_vehicle_type_ids_[pos] = vehicle_type_id;
+                }
+            }
+        }
+
+        Output output;
+        if (values_[n] == std::numeric_limits<Cost>::max())
+            return output;
+        output.feasible = true;
+        output.cost = values_[n];
+        for (LocationPos pos = n; pos > 0; pos = predecessors_[pos]) {
+            output.routes.push_back({
+                    predecessor_vehicle_type_ids_[pos],
+                    predecessors_[pos],
+                    pos - 1});
+        }
+        std::reverse(output.routes.begin(), output.routes.end());
+        return output;
+    }
+
+    /** Structure for a label of the limited fleet split. */
+    struct Label
+    {
+        /** Cost. */
+        Cost cost;
+
+        /** Number of vehicles used for each element of the fleet. */
+        std::vector<RouteId> number_of_vehicles;
+
+        /** Position of the predecessor. */
+        LocationPos predecessor_pos;
+
+        /** Id of the predecessor label. */
+        int64_t predecessor_label_id;
+
+        /** Vehicle type of the last route. */
+        VehicleTypeId vehicle_type_id;
+    };
+
+    /** Split with the fleet size constraints. */
+    Output split_limited()
+    {
+        LocationPos n = giant_tour_->size();
+        const auto& fleet = instance_.fleet();
+        std::vector<std::vector<Label>> labels(n + 1);
+        labels[0].push_back({0, std::vector<RouteId>(fleet.size(), 0), -1, -1, -1});
+
+        for (LocationPos pos = 0; pos < n; ++pos) {
+            for (int64_t label_id = 0;
+                    label_id < (int64_t)labels[pos].size();
+                    ++label_id) {
+                for (LocationPos pos_next = pos + 1;
+                        pos_next <= n
+                        && loads_[pos_next] - loads_[pos] <= maximum_capacity_;
+                        ++pos_next) {
+                    for (VehicleTypeId fleet_pos = 0;
+                            fleet_pos < (VehicleTypeId)fleet.size();
+                            ++fleet_pos) {
+                        const Label& label = labels[pos][label_id];
+                        if (label.number_of_vehicles[fleet_pos] >= fleet[fleet_pos].second)
+                            continue;
+                        VehicleTypeId vehicle_type_id = fleet[fleet_pos].first;
+                        const VehicleType& vehicle_type = instance_.vehicle_type(vehicle_type_id);
+                        if (loads_[pos_next] - loads_[pos] > vehicle_type.capacity)
+                            continue;
+                        Label label_next;
+                        label_next.cost = label.cost
+                            + vehicle_type.fixed_cost
+                            + vehicle_type.variable_cost
+                            * (head_costs_[pos] + tail_costs_[pos_next]);
+                        label_next.number_of_vehicles = label.number_of_vehicles;
+                        label_next.number_of_vehicles[fleet_pos]++;
+                        label_next.predecessor_pos = pos;
+                        label_next.predecessor_label_id = label_id;
+                        label_next.vehicle_type_id = vehicle_type_id;
+                        add_label(labels[pos_next], label_next);
+                    }
+                }
+            }
+        }
+
+        Output output;
+        if (labels[n].empty())
+            return output;
+        int64_t label_id = 0;
+        for (int64_t label_id_2 = 1;
+                label_id_2 < (int64_t)labels[n].size();
+                ++label_id_2) {
+            if (labels[n][label_id].cost > labels[n][label_id_2].cost)
+                label_id = label_id_2;
+        }
+        output.feasible = true;
+        output.cost = labels[n][label_id].cost;
+        for (LocationPos pos = n; pos > 0;) {
+            const Label& label = labels[pos][label_id];
+            output.routes.push_back({
+                    label.vehicle_type_id,
+                    label.predecessor_pos,
+                    pos - 1});
+            pos = label.predecessor_pos;
+            label_id = label.predecessor_label_id;
+        }
+        std::reverse(output.routes.begin(), output.routes.end());
+        return output;
+    }
+
+    /** Add a label to a list of non-dominated labels. */
+    static void add_label(
+            std::vector<Label>& labels,
+            const Label& label)
+    {
+        auto dominates = [](const Label& label_1, const Label& label_2)
+        {
+            if (label_1.cost > label_2.cost)
+                return false;
+            for (VehicleTypeId fleet_pos = 0;
+                    fleet_pos < (VehicleTypeId)label_1.number_of_vehicles.size();
+                    ++fleet_pos) {
+                if (label_1.number_of_vehicles[fleet_pos]
+                        > label_2.number_of_vehicles[fleet_pos]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Labels of a position are only extended once all of them have been
+        // generated, so dominated labels can be removed.
+        for (const Label& label_2: labels)
+            if (dominates(label_2, label))
+                return;
+        labels.erase(
+                std::remove_if(
+                    labels.begin(),
+                    labels.end(),
+                    [&label, &dominates](const Label& label_2) { return dominates(label, label_2); }),
+                labels.end());
+        labels.push_back(label);
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Maximum capacity of a vehicle of the fleet. */
+    Demand maximum_capacity_ = 0;
+
+    /** Giant tour. */
+    const std::vector<LocationId>* giant_tour_ = nullptr;
+
+    /** Prefix loads of the giant tour. */
+    std::vector<Demand> loads_;
+
+    /** Prefix lengths of the giant tour. */
+    std::vector<Distance> lengths_;
+
+    /** Part of the length of a route which depends on its first position. */
+    std::vector<Distance> head_costs_;
+
+    /** Part of the length of a route which depends on its last position. */
+    std::vector<Distance> tail_costs_;
+
+    /** Values of the dynamic program. */
+    std::vector<Cost> values_;
+
+    /** Predecessors of the dynamic program. */
+    std::vector<LocationPos> predecessors_;
+
+    /** Vehicle types of the predecessors of the dynamic program. */
+    std::vector<VehicleTypeId> predecessor_vehicle_type_ids_;
+
+    /** Monotone queues, one for each element of the fleet. */
+    std::vector<std::deque<LocationPos>> queues_;
+
+};
+
 }
 }
@@ -34,6 +34,10 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <limits>
 
 namespace orproblems
 {
@@ -63,6 +67,32 @@ struct Location
 };
 
 
+/**
+ * Enumeration of the storage modes of the travel times.
+ */
+enum class TravelTimesStorage
+{
+    /** Full n×n matrix. */
+    Full,
+
+    /** Upper triangle of a symmetric matrix. */
+    Symmetric,
+
+    /**
+     * Upper triangle of a symmetric matrix, in single precision.
+     *
+     * Travel times are rounded to the nearest 'float' for 'travel_time'. This
+     * mode is only used if the exact travel times can still be recovered,
+     * i.e. if they are exactly representable as 'float' or if they are equal
+     * to the ones computed from the coordinates; otherwise, 'Symmetric' is
+     * used. 'exact_travel_time' always returns the exact travel times.
+     */
+    SymmetricFloat,
+
+    /** Travel times computed on demand from the coordinates of the locations. */
+    Coordinates,
+};
+
 /**
  * Instance class for a 'orienteering_with_hotel_selection' problem.
  */
@@ -93,12 +123,88 @@ public:
     /** Get the maximum duration of a given trip. */
     inline Time maximum_duration(TripId trip_id) const { return trip_maximum_duration_[trip_id]; }
 
-    /** Get the travel time between two locations. */
+    /** Get the storage mode of the travel times. */
+    inline TravelTimesStorage travel_times_storage() const { return travel_times_storage_; }
+
+    /**
+     * Get the travel time between two locations for a given storage mode.
+     *
+     * The storage mode must be the one of the instance. Since it is known at
+     * compile time, this method doesn't branch on it.
+     */
+    template <TravelTimesStorage travel_times_storage>
     inline Time travel_time(
             LocationId location_id_1,
             LocationId location_id_2) const
     {
-        return travel_times_[location_id_1][location_id_2];
+        if (travel_times_storage == TravelTimesStorage::Full) {
+            return travel_times_[location_id_1 * number_of_locations() + location_id_2];
+        } else if (travel_times_storage == TravelTimesStorage::Symmetric) {
+            return travel_times_[symmetric_index(location_id_1, location_id_2)];
+        } else if (travel_times_storage == TravelTimesStorage::SymmetricFloat) {
+            return travel_times_float_[symmetric_index(location_id_1, location_id_2)];
+        } else {
+            if (location_id_1 == location_id_2)
+                return travel_times_[location_id_1];
+            return compute_travel_time(location_id_1, location_id_2);
+        }
+    }
+
+    /**
+     * Call a function with the storage mode of the travel times as a
+     * compile-time constant.
+     *
+     * The function receives a 'std::integral_constant<TravelTimesStorage, S>'
+     * and can call 'travel_time<S>()' without branching on the storage mode.
+     */
+    template <typename Function>
+    inline auto visit_travel_times_storage(Function function) const
+    {
+        if (travel_times_storage_ == TravelTimesStorage::Full) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Full>());
+        } else if (travel_times_storage_ == TravelTimesStorage::Symmetric) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Symmetric>());
+        } else if (travel_times_storage_ == TravelTimesStorage::SymmetricFloat) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::SymmetricFloat>());
+        } else {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Coordinates>());
+        }
+    }
+
+    /**
+     * Get the travel time between two locations.
+     *
+     * This method dispatches on the storage mode at each call. In hot loops,
+     * prefer dispatching once with 'visit_travel_times_storage'.
+     */
+    inline Time travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        return visit_travel_times_storage(
+                [this, location_id_1, location_id_2](auto storage)
+                {
+                    return this->travel_time<decltype(storage)::value>(
+                            location_id_1,
+                            location_id_2);
+                });
+    }
+
+    /**
+     * Get the exact travel time between two locations.
+     *
+     * It differs from 'travel_time' only with the 'SymmetricFloat' storage
+     * mode, if the travel times are not exactly representable as 'float'.
+     */
+    inline Time exact_travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        if (!exact_travel_times_from_coordinates_)
+            return travel_time(location_id_1, location_id_2);
+        if (location_id_1 == location_id_2)
+            return travel_times_[location_id_1];
+        return compute_travel_time(location_id_1, location_id_2);
     }
 
     /*
@@ -213,15 +319,15 @@ public:
                         << std::endl;
             }
 
-            trip_duration += travel_time(location_id_prev, location_id);
-            total_duration += travel_time(location_id_prev, location_id);
+            trip_duration += exact_travel_time(location_id_prev, location_id);
+            total_duration += exact_travel_time(location_id_prev, location_id);
             profit += location(location_id).profit;
 
             if (verbosity_level >= 2) {
                 os
                     << std::setw(12) << location_id
                     << std::setw(12) << location(location_id).profit
-                    << std::setw(12) << travel_time(location_id_prev, location_id)
+                    << std::setw(12) << exact_travel_time(location_id_prev, location_id)
                     << std::setw(12) << trip_duration
                     << std::setw(12) << total_duration
                     << std::setw(12) << profit
@@ -261,13 +367,13 @@ public:
         }
         // Finish last trip.
         location_id = 1;
-        trip_duration += travel_time(location_id_prev, location_id);
-        total_duration += travel_time(location_id_prev, location_id);
+        trip_duration += exact_travel_time(location_id_prev, location_id);
+        total_duration += exact_travel_time(location_id_prev, location_id);
         if (verbosity_level >= 2) {
             os
                 << std::setw(12) << location_id
                 << std::setw(12) << location(location_id).profit
-                << std::setw(12) << travel_time(location_id_prev, location_id)
+                << std::setw(12) << exact_travel_time(location_id_prev, location_id)
                 << std::setw(12) << trip_duration
                 << std::setw(12) << total_duration
                 << std::setw(12) << profit
@@ -316,6 +422,29 @@ private:
     /** Constructor to build an instance manually. */
     Instance() { }
 
+    /**
+     * Get the index of the travel time between two locations in the upper
+     * triangle storage.
+     */
+    inline std::size_t symmetric_index(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        std::size_t i = std::min(location_id_1, location_id_2);
+        std::size_t j = std::max(location_id_1, location_id_2);
+        return i * (2 * number_of_locations() - i + 1) / 2 + (j - i);
+    }
+
+    /** Compute the travel time between two locations from their coordinates. */
+    inline Time compute_travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        double xd = location(location_id_2).x - location(location_id_1).x;
+        double yd = location(location_id_2).y - location(location_id_1).y;
+        return std::sqrt(xd * xd + yd * yd);
+    }
+
     /*
      * Private attributes
      */
@@ -329,8 +458,27 @@ private:
     /** Maximum duration of the trips. */
     std::vector<Time> trip_maximum_duration_;
 
-    /** Travel times. */
-    std::vector<std::vector<Time>> travel_times_;
+    /** Storage mode of the travel times. */
+    TravelTimesStorage travel_times_storage_ = TravelTimesStorage::Full;
+
+    /**
+     * Travel times.
+     *
+     * Depending on the storage mode, it contains the full matrix, its upper
+     * triangle or only its diagonal.
+     */
+    std::vector<Time> travel_times_;
+
+    /** Travel times in single precision. */
+    std::vector<float> travel_times_float_;
+
+    /**
+     * 'true' iff the travel times are stored in single precision but are not
+     * exactly representable as 'float'. The exact travel times are then
+     * computed from the coordinates, and 'travel_times_' contains the
+     * diagonal of the matrix.
+     */
+    bool exact_travel_times_from_coordinates_ = false;
 
     /** Maximum duration. */
     Time maximum_duration_ = 0;
@@ -354,9 +502,7 @@ public:
     void set_number_of_locations(LocationId number_of_locations)
     {
         instance_.locations_ = std::vector<Location>(number_of_locations),
-        instance_.travel_times_ = std::vector<std::vector<Time>>(
-                number_of_locations,
-                std::vector<Time>(number_of_locations, -1));
+        travel_times_ = std::vector<Time>(number_of_locations * number_of_locations, -1);
     }
 
     /** Set the number of extra hotels. */
@@ -404,10 +550,23 @@ public:
             LocationId location_id_2,
             Time travel_time)
     {
-        instance_.travel_times_[location_id_1][location_id_2] = travel_time;
-        instance_.travel_times_[location_id_2][location_id_1] = travel_time;
+        LocationId number_of_locations = instance_.number_of_locations();
+        travel_times_[location_id_1 * number_of_locations + location_id_2] = travel_time;
+        travel_times_[location_id_2 * number_of_locations + location_id_1] = travel_time;
     }
 
+    /**
+     * Set the storage mode of the travel times.
+     *
+     * If the travel times are not symmetric or don't match the coordinates,
+     * a more general storage mode is used when building the instance.
+     * 'SymmetricFloat' is used if the travel times are exactly representable
+     * as 'float' or match the coordinates; in the latter case, 'travel_time'
+     * returns travel times rounded to single precision, while 'check' uses
+     * the exact ones.
+     */
+    void set_travel_times_storage(TravelTimesStorage travel_times_storage) { travel_times_storage_ = travel_times_storage; }
+
     /** Build an instance from a file. */
     void read(
             const std::string& instance_path,
@@ -434,6 +593,69 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        // Select the storage mode of the travel times.
+        TravelTimesStorage travel_times_storage = travel_times_storage_;
+        if (travel_times_storage == TravelTimesStorage::Coordinates
+                && !travel_times_match_coordinates()) {
+            travel_times_storage = TravelTimesStorage::Full;
+        }
+        if ((travel_times_storage == TravelTimesStorage::Symmetric
+                    || travel_times_storage == TravelTimesStorage::SymmetricFloat)
+                && !travel_times_are_symmetric()) {
+            travel_times_storage = TravelTimesStorage::Full;
+        }
+        bool exact_travel_times_from_coordinates = false;
+        if (travel_times_storage == TravelTimesStorage::SymmetricFloat
+                && !travel_times_fit_in_float()) {
+            if (travel_times_match_coordinates()) {
+                exact_travel_times_from_coordinates = true;
+            } else {
+                travel_times_storage = TravelTimesStorage::Symmetric;
+            }
+        }
+        instance_.travel_times_storage_ = travel_times_storage;
+        instance_.exact_travel_times_from_coordinates_ = exact_travel_times_from_coordinates;
+
+        // Store travel times.
+        LocationId number_of_locations = instance_.number_of_locations();
+        instance_.travel_times_.clear();
+        instance_.travel_times_float_.clear();
+        if (travel_times_storage == TravelTimesStorage::Full) {
+            instance_.travel_times_ = std::move(travel_times_);
+        } else if (travel_times_storage == TravelTimesStorage::Symmetric
+                || travel_times_storage == TravelTimesStorage::SymmetricFloat) {
+            for (LocationId location_id_1 = 0;
+                    location_id_1 < number_of_locations;
+                    ++location_id_1) {
+                for (LocationId location_id_2 = location_id_1;
+                        location_id_2 < number_of_locations;
+                        ++location_id_2) {
+                    Time travel_time = travel_times_[location_id_1 * number_of_locations + location_id_2];
+                    if (travel_times_storage == TravelTimesStorage::Symmetric) {
+                        instance_.travel_times_.push_back(travel_time);
+                    } else {
+                        instance_.travel_times_float_.push_back(travel_time);
+                    }
+                }
+            }
+            if (exact_travel_times_from_coordinates) {
+                for (LocationId location_id = 0;
+                        location_id < number_of_locations;
+                        ++location_id) {
+                    instance_.travel_times_.push_back(
+                            travel_times_[location_id * number_of_locations + location_id]);
+                }
+            }
+        } else {
+            for (LocationId location_id = 0;
+                    location_id < number_of_locations;
+                    ++location_id) {
+                instance_.travel_times_.push_back(
+                        travel_times_[location_id * number_of_locations + location_id]);
+            }
+        }
+        travel_times_.clear();
+
         return std::move(instance_);
     }
 
@@ -443,6 +665,58 @@ private:
      * Private methods
      */
 
+    /** Return 'true' iff the travel time matrix is symmetric. */
+    bool travel_times_are_symmetric() const
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = location_id_1 + 1;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                if (travel_times_[location_id_1 * number_of_locations + location_id_2]
+                        != travel_times_[location_id_2 * number_of_locations + location_id_1]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /** Return 'true' iff all travel times are exactly representable as 'float'. */
+    bool travel_times_fit_in_float() const
+    {
+        for (Time travel_time: travel_times_)
+            if ((Time)(float)travel_time != travel_time)
+                return false;
+        return true;
+    }
+
+    /**
+     * Return 'true' iff all travel times between different locations are
+     * equal to the ones computed from the coordinates.
+     */
+    bool travel_times_match_coordinates() const
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = 0;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                if (location_id_1 == location_id_2)
+                    continue;
+                if (travel_times_[location_id_1 * number_of_locations + location_id_2]
+                        != instance_.compute_travel_time(location_id_1, location_id_2)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     /** Read an instance from a file in 'divsalar2013' format. */
     void read_divsalar2013(
             std::ifstream& file)
@@ -495,6 +769,243 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Travel times, stored as a full matrix while building. */
+    std::vector<Time> travel_times_;
+
+    /** Requested storage mode of the travel times. */
+    TravelTimesStorage travel_times_storage_ = TravelTimesStorage::Full;
+
+};
+
+/**
+ * Precomputed data on the trips between each pair of hotels of an
+ * 'orienteering_with_hotel_selection' problem.
+ *
+ * For each ordered pair of hotels (h₁, h₂), it stores:
+ * - the direct travel time from h₁ to h₂
+ * - the customers c sorted by increasing detour time t(h₁, c) + t(c, h₂)
+ * - for each distinct trip maximum duration, the number of customers whose
+ *   detour fits within it and the sum of their profits
+ *
+ * Since travel times satisfy the triangle inequality, a trip from h₁ to h₂
+ * whose duration does not exceed a limit can only visit customers whose
+ * detour fits within this limit. Thus, the sum of their profits is an upper
+ * bound on the profit collectable during the trip.
+ *
+ * All queries run in O(1).
+ *
+ * With the 'SymmetricFloat' storage mode, the travel times used are rounded
+ * to single precision, so the results are approximate.
+ */
+class HotelPairCache
+{
+
+public:
+
+    /** Constructor. */
+    HotelPairCache(const Instance& instance):
+        instance_(instance)
+    {
+        // Compute the distinct trip maximum durations.
+        for (TripId trip_id = 0; trip_id < instance.number_of_trips(); ++trip_id)
+            duration_limits_.push_back(instance.maximum_duration(trip_id));
+        std::sort(duration_limits_.begin(), duration_limits_.end());
+        duration_limits_.erase(
+                std::unique(duration_limits_.begin(), duration_limits_.end()),
+                duration_limits_.end());
+        for (TripId trip_id = 0; trip_id < instance.number_of_trips(); ++trip_id) {
+            trip_duration_limit_pos_.push_back(std::distance(
+                        duration_limits_.begin(),
+                        std::lower_bound(
+                            duration_limits_.begin(),
+                            duration_limits_.end(),
+                            instance.maximum_duration(trip_id))));
+        }
+        instance.visit_travel_times_storage(
+                [this](auto storage)
+                {
+                    this->compute_pairs<decltype(storage)::value>();
+                });
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of hotels, including the starting and ending hotels. */
+    inline LocationId number_of_hotels() const { return instance_.number_of_extra_hotels() + 2; }
+
+    /** Get the number of distinct trip maximum durations. */
+    inline TripId number_of_duration_limits() const { return duration_limits_.size(); }
+
+    /** Get a distinct trip maximum duration. */
+    inline Time duration_limit(TripId limit_pos) const { return duration_limits_[limit_pos]; }
+
+    /** Get the position of the maximum duration of a trip among the distinct ones. */
+    inline TripId duration_limit_pos(TripId trip_id) const { return trip_duration_limit_pos_[trip_id]; }
+
+    /** Get the direct travel time between two hotels. */
+    inline Time direct_travel_time(
+            LocationId hotel_id_1,
+            LocationId hotel_id_2) const
+    {
+        return direct_travel_times_[hotel_id_1 * number_of_hotels() + hotel_id_2];
+    }
+
+    /**
+     * Return 'true' iff the direct trip from a hotel to another fits in the
+     * maximum duration of a trip.
+     */
+    inline bool feasible(
+            LocationId hotel_id_1,
+            LocationId hotel_id_2,
+            TripId trip_id) const
+    {
+        return direct_travel_time(hotel_id_1, hotel_id_2) <= instance_.maximum_duration(trip_id);
+    }
+
+    /**
+     * Get the number of customers whose detour between two hotels fits in the
+     * maximum duration of a trip.
+     */
+    inline LocationPos number_of_customers(
+            LocationId hotel_id_1,
+            LocationId hotel_id_2,
+            TripId trip_id) const
+    {
+        return number_of_customers_[index(hotel_id_1, hotel_id_2, trip_id)];
+    }
+
+    /**
+     * Get the customers of a pair of hotels sorted by increasing detour time.
+     *
+     * The detours of the first 'number_of_customers(hotel_id_1, hotel_id_2,
+     * trip_id)' customers fit in the maximum duration of trip 'trip_id'.
+     */
+    inline const LocationId* customers(
+            LocationId hotel_id_1,
+            LocationId hotel_id_2) const
+    {
+        return customers_.data() + customers_offsets_[hotel_id_1 * number_of_hotels() + hotel_id_2];
+    }
+
+    /**
+     * Get an upper bound on the profit collectable during a trip between two
+     * hotels.
+     */
+    inline Profit profit_upper_bound(
+            LocationId hotel_id_1,
+            LocationId hotel_id_2,
+            TripId trip_id) const
+    {
+        return profit_upper_bounds_[index(hotel_id_1, hotel_id_2, trip_id)];
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Get the index of a pair of hotels and of a trip in the tables. */
+    inline LocationPos index(
+            LocationId hotel_id_1,
+            LocationId hotel_id_2,
+            TripId trip_id) const
+    {
+        return (hotel_id_1 * number_of_hotels() + hotel_id_2) * number_of_duration_limits()
+            + trip_duration_limit_pos_[trip_id];
+    }
+
+    /**
+     * Compute the direct travel times, the customers and the profit upper
+     * bounds of each pair of hotels.
+     */
+    template <TravelTimesStorage travel_times_storage>
+    void compute_pairs()
+    {
+        LocationId number_of_hotels = this->number_of_hotels();
+        Time largest_duration_limit = (duration_limits_.empty())?
+            -std::numeric_limits<Time>::infinity():
+            duration_limits_.back();
+
+        TripId number_of_duration_limits = duration_limits_.size();
+        LocationId number_of_pairs = number_of_hotels * number_of_hotels;
+        direct_travel_times_.resize(number_of_pairs);
+        customers_offsets_.resize(number_of_pairs + 1);
+        number_of_customers_.resize(number_of_pairs * number_of_duration_limits);
+        profit_upper_bounds_.resize(number_of_pairs * number_of_duration_limits);
+        customers_offsets_[0] = 0;
+        std::vector<std::pair<Time, LocationId>> detours;
+        for (LocationId hotel_id_1 = 0; hotel_id_1 < number_of_hotels; ++hotel_id_1) {
+            for (LocationId hotel_id_2 = 0; hotel_id_2 < number_of_hotels; ++hotel_id_2) {
+                LocationId pair_id = hotel_id_1 * number_of_hotels + hotel_id_2;
+                direct_travel_times_[pair_id] = (hotel_id_1 == hotel_id_2)?
+                    0: instance_.travel_time<travel_times_storage>(hotel_id_1, hotel_id_2);
+
+                // Sort the customers by detour time.
+                detours.clear();
+                for (LocationId location_id = number_of_hotels;
+                        location_id < instance_.number_of_locations();
+                        ++location_id) {
+                    Time detour
+                        = instance_.travel_time<travel_times_storage>(hotel_id_1, location_id)
+                        + instance_.travel_time<travel_times_storage>(location_id, hotel_id_2);
+                    if (detour <= largest_duration_limit)
+                        detours.push_back({detour, location_id});
+                }
+                std::sort(detours.begin(), detours.end());
+
+                // Store the customers and compute, for each duration limit,
+                // the number of customers which fit and their total profit.
+                LocationPos pos = 0;
+                Profit profit = 0;
+                for (TripId limit_pos = 0;
+                        limit_pos < number_of_duration_limits;
+                        ++limit_pos) {
+                    for (;
+                            pos < (LocationPos)detours.size()
+                            && detours[pos].first <= duration_limits_[limit_pos];
+                            ++pos) {
+                        customers_.push_back(detours[pos].second);
+                        profit += instance_.location(detours[pos].second).profit;
+                    }
+                    number_of_customers_[pair_id * number_of_duration_limits + limit_pos] = pos;
+                    profit_upper_bounds_[pair_id * number_of_duration_limits + limit_pos] = profit;
+                }
+                customers_offsets_[pair_id + 1] = customers_.size();
+            }
+        }
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Distinct trip maximum durations, sorted in increasing order. */
+    std::vector<Time> duration_limits_;
+
+    /** For each trip, the position of its maximum duration in 'duration_limits_'. */
+    std::vector<TripId> trip_duration_limit_pos_;
+
+    /** Direct travel times between each pair of hotels. */
+    std::vector<Time> direct_travel_times_;
+
+    /** For each pair of hotels, the customers sorted by detour time. */
+    std::vector<LocationId> customers_;
+
+    /** Offsets of the customers of each pair of hotels in 'customers_'. */
+    std::vector<LocationPos> customers_offsets_;
+
+    /** Number of customers for each pair of hotels and each duration limit. */
+    std::vector<LocationPos> number_of_customers_;
+
+    /** Profit upper bound for each pair of hotels and each duration limit. */
+    std::vector<Profit> profit_upper_bounds_;
+
 };
 
 }
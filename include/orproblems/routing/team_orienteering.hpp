@@ -27,6 +27,9 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 
 namespace orproblems
 {
@@ -55,6 +58,32 @@ struct Location
 };
 
 
+/**
+ * Enumeration of the storage modes of the travel times.
+ */
+enum class TravelTimesStorage
+{
+    /** Full n×n matrix. */
+    Full,
+
+    /** Upper triangle of a symmetric matrix. */
+    Symmetric,
+
+    /**
+     * Upper triangle of a symmetric matrix, in single precision.
+     *
+     * Travel times are rounded to the nearest 'float' for 'travel_time'. This
+     * mode is only used if the exact travel times can still be recovered,
+     * i.e. if they are exactly representable as 'float' or if they are equal
+     * to the ones computed from the coordinates; otherwise, 'Symmetric' is
+     * used. 'exact_travel_time' always returns the exact travel times.
+     */
+    SymmetricFloat,
+
+    /** Travel times computed on demand from the coordinates of the locations. */
+    Coordinates,
+};
+
 /**
  * Instance class for a 'team_orienteering' problem.
  */
@@ -79,12 +108,88 @@ public:
     /** Get the maximum duration. */
     inline Time maximum_duration() const { return maximum_duration_; }
 
-    /** Get the travel time between two locations. */
+    /** Get the storage mode of the travel times. */
+    inline TravelTimesStorage travel_times_storage() const { return travel_times_storage_; }
+
+    /**
+     * Get the travel time between two locations for a given storage mode.
+     *
+     * The storage mode must be the one of the instance. Since it is known at
+     * compile time, this method doesn't branch on it.
+     */
+    template <TravelTimesStorage travel_times_storage>
     inline Time travel_time(
             LocationId location_id_1,
             LocationId location_id_2) const
     {
-        return travel_times_[location_id_1][location_id_2];
+        if (travel_times_storage == TravelTimesStorage::Full) {
+            return travel_times_[location_id_1 * number_of_locations() + location_id_2];
+        } else if (travel_times_storage == TravelTimesStorage::Symmetric) {
+            return travel_times_[symmetric_index(location_id_1, location_id_2)];
+        } else if (travel_times_storage == TravelTimesStorage::SymmetricFloat) {
+            return travel_times_float_[symmetric_index(location_id_1, location_id_2)];
+        } else {
+            if (location_id_1 == location_id_2)
+                return travel_times_[location_id_1];
+            return compute_travel_time(location_id_1, location_id_2);
+        }
+    }
+
+    /**
+     * Call a function with the storage mode of the travel times as a
+     * compile-time constant.
+     *
+     * The function receives a 'std::integral_constant<TravelTimesStorage, S>'
+     * and can call 'travel_time<S>()' without branching on the storage mode.
+     */
+    template <typename Function>
+    inline auto visit_travel_times_storage(Function function) const
+    {
+        if (travel_times_storage_ == TravelTimesStorage::Full) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Full>());
+        } else if (travel_times_storage_ == TravelTimesStorage::Symmetric) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Symmetric>());
+        } else if (travel_times_storage_ == TravelTimesStorage::SymmetricFloat) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::SymmetricFloat>());
+        } else {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Coordinates>());
+        }
+    }
+
+    /**
+     * Get the travel time between two locations.
+     *
+     * This method dispatches on the storage mode at each call. In hot loops,
+     * prefer dispatching once with 'visit_travel_times_storage'.
+     */
+    inline Time travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        return visit_travel_times_storage(
+                [this, location_id_1, location_id_2](auto storage)
+                {
+                    return this->travel_time<decltype(storage)::value>(
+                            location_id_1,
+                            location_id_2);
+                });
+    }
+
+    /**
+     * Get the exact travel time between two locations.
+     *
+     * It differs from 'travel_time' only with the 'SymmetricFloat' storage
+     * mode, if the travel times are not exactly representable as 'float'.
+     */
+    inline Time exact_travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        if (!exact_travel_times_from_coordinates_)
+            return travel_time(location_id_1, location_id_2);
+        if (location_id_1 == location_id_2)
+            return travel_times_[location_id_1];
+        return compute_travel_time(location_id_1, location_id_2);
     }
 
     /*
@@ -202,7 +307,7 @@ public:
                             << std::endl;
                 }
 
-                tour_duration += travel_time(location_id_prev, location_id);
+                tour_duration += exact_travel_time(location_id_prev, location_id);
                 profit += location(location_id).profit;
 
                 if (verbosity_level >= 3) {
@@ -210,7 +315,7 @@ public:
                         << std::setw(12) << vehicle_id
                         << std::setw(12) << location_id
                         << std::setw(12) << location(location_id).profit
-                        << std::setw(12) << travel_time(location_id_prev, location_id)
+                        << std::setw(12) << exact_travel_time(location_id_prev, location_id)
                         << std::setw(12) << tour_duration
                         << std::setw(12) << profit
                         << std::endl;
@@ -229,7 +334,7 @@ public:
             }
 
             // Finish last tour.
-            tour_duration += travel_time(
+            tour_duration += exact_travel_time(
                     location_id_prev,
                     number_of_locations() - 1);
             if (verbosity_level >= 3) {
@@ -237,7 +342,7 @@ public:
                     << std::setw(12) << vehicle_id
                     << std::setw(12) << 0
                     << std::setw(12) << location(location_id).profit
-                    << std::setw(12) << travel_time(location_id_prev, location_id)
+                    << std::setw(12) << exact_travel_time(location_id_prev, location_id)
                     << std::setw(12) << tour_duration
                     << std::setw(12) << profit
                     << std::endl;
@@ -281,6 +386,29 @@ private:
     /** Constructor to build an instance manually. */
     Instance() { }
 
+    /**
+     * Get the index of the travel time between two locations in the upper
+     * triangle storage.
+     */
+    inline std::size_t symmetric_index(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        std::size_t i = std::min(location_id_1, location_id_2);
+        std::size_t j = std::max(location_id_1, location_id_2);
+        return i * (2 * number_of_locations() - i + 1) / 2 + (j - i);
+    }
+
+    /** Compute the travel time between two locations from their coordinates. */
+    inline Time compute_travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        double xd = location(location_id_2).x - location(location_id_1).x;
+        double yd = location(location_id_2).y - location(location_id_1).y;
+        return std::sqrt(xd * xd + yd * yd);
+    }
+
     /*
      * Private attributes
      */
@@ -291,8 +419,27 @@ private:
     /** Number of vehicles. */
     VehicleId number_of_vehicles_ = 0;
 
-    /** Travel times. */
-    std::vector<std::vector<Time>> travel_times_;
+    /** Storage mode of the travel times. */
+    TravelTimesStorage travel_times_storage_ = TravelTimesStorage::Full;
+
+    /**
+     * Travel times.
+     *
+     * Depending on the storage mode, it contains the full matrix, its upper
+     * triangle or only its diagonal.
+     */
+    std::vector<Time> travel_times_;
+
+    /** Travel times in single precision. */
+    std::vector<float> travel_times_float_;
+
+    /**
+     * 'true' iff the travel times are stored in single precision but are not
+     * exactly representable as 'float'. The exact travel times are then
+     * computed from the coordinates, and 'travel_times_' contains the
+     * diagonal of the matrix.
+     */
+    bool exact_travel_times_from_coordinates_ = false;
 
     /** Maximum duration. */
     Time maximum_duration_ = 0;
@@ -316,9 +463,7 @@ public:
     void set_number_of_locations(LocationId number_of_locations)
     {
         instance_.locations_ = std::vector<Location>(number_of_locations),
-        instance_.travel_times_ = std::vector<std::vector<Time>>(
-                number_of_locations,
-                std::vector<Time>(number_of_locations, -1));
+        travel_times_ = std::vector<Time>(number_of_locations * number_of_locations, -1);
     }
 
     /** Set the number of vehicles. */
@@ -359,10 +504,23 @@ public:
             LocationId location_id_2,
             Time travel_time)
     {
-        instance_.travel_times_[location_id_1][location_id_2] = travel_time;
-        instance_.travel_times_[location_id_2][location_id_1] = travel_time;
+        LocationId number_of_locations = instance_.number_of_locations();
+        travel_times_[location_id_1 * number_of_locations + location_id_2] = travel_time;
+        travel_times_[location_id_2 * number_of_locations + location_id_1] = travel_time;
     }
 
+    /**
+     * Set the storage mode of the travel times.
+     *
+     * If the travel times are not symmetric or don't match the coordinates,
+     * a more general storage mode is used when building the instance.
+     * 'SymmetricFloat' is used if the travel times are exactly representable
+     * as 'float' or match the coordinates; in the latter case, 'travel_time'
+     * returns travel times rounded to single precision, while 'check' uses
+     * the exact ones.
+     */
+    void set_travel_times_storage(TravelTimesStorage travel_times_storage) { travel_times_storage_ = travel_times_storage; }
+
     /** Build an instance from a file. */
     void read(
             const std::string& instance_path,
@@ -389,6 +547,69 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        // Select the storage mode of the travel times.
+        TravelTimesStorage travel_times_storage = travel_times_storage_;
+        if (travel_times_storage == TravelTimesStorage::Coordinates
+                && !travel_times_match_coordinates()) {
+            travel_times_storage = TravelTimesStorage::Full;
+        }
+        if ((travel_times_storage == TravelTimesStorage::Symmetric
+                    || travel_times_storage == TravelTimesStorage::SymmetricFloat)
+                && !travel_times_are_symmetric()) {
+            travel_times_storage = TravelTimesStorage::Full;
+        }
+        bool exact_travel_times_from_coordinates = false;
+        if (travel_times_storage == TravelTimesStorage::SymmetricFloat
+                && !travel_times_fit_in_float()) {
+            if (travel_times_match_coordinates()) {
+                exact_travel_times_from_coordinates = true;
+            } else {
+                travel_times_storage = TravelTimesStorage::Symmetric;
+            }
+        }
+        instance_.travel_times_storage_ = travel_times_storage;
+        instance_.exact_travel_times_from_coordinates_ = exact_travel_times_from_coordinates;
+
+        // Store travel times.
+        LocationId number_of_locations = instance_.number_of_locations();
+        instance_.travel_times_.clear();
+        instance_.travel_times_float_.clear();
+        if (travel_times_storage == TravelTimesStorage::Full) {
+            instance_.travel_times_ = std::move(travel_times_);
+        } else if (travel_times_storage == TravelTimesStorage::Symmetric
+                || travel_times_storage == TravelTimesStorage::SymmetricFloat) {
+            for (LocationId location_id_1 = 0;
+                    location_id_1 < number_of_locations;
+                    ++location_id_1) {
+                for (LocationId location_id_2 = location_id_1;
+                        location_id_2 < number_of_locations;
+                        ++location_id_2) {
+                    Time travel_time = travel_times_[location_id_1 * number_of_locations + location_id_2];
+                    if (travel_times_storage == TravelTimesStorage::Symmetric) {
+                        instance_.travel_times_.push_back(travel_time);
+                    } else {
+                        instance_.travel_times_float_.push_back(travel_time);
+                    }
+                }
+            }
+            if (exact_travel_times_from_coordinates) {
+                for (LocationId location_id = 0;
+                        location_id < number_of_locations;
+                        ++location_id) {
+                    instance_.travel_times_.push_back(
+                            travel_times_[location_id * number_of_locations + location_id]);
+                }
+            }
+        } else {
+            for (LocationId location_id = 0;
+                    location_id < number_of_locations;
+                    ++location_id) {
+                instance_.travel_times_.push_back(
+                        travel_times_[location_id * number_of_locations + location_id]);
+            }
+        }
+        travel_times_.clear();
+
         return std::move(instance_);
     }
 
@@ -398,6 +619,58 @@ private:
      * Private methods
      */
 
+    /** Return 'true' iff the travel time matrix is symmetric. */
+    bool travel_times_are_symmetric() const
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = location_id_1 + 1;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                if (travel_times_[location_id_1 * number_of_locations + location_id_2]
+                        != travel_times_[location_id_2 * number_of_locations + location_id_1]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /** Return 'true' iff all travel times are exactly representable as 'float'. */
+    bool travel_times_fit_in_float() const
+    {
+        for (Time travel_time: travel_times_)
+            if ((Time)(float)travel_time != travel_time)
+                return false;
+        return true;
+    }
+
+    /**
+     * Return 'true' iff all travel times between different locations are
+     * equal to the ones computed from the coordinates.
+     */
+    bool travel_times_match_coordinates() const
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = 0;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                if (location_id_1 == location_id_2)
+                    continue;
+                if (travel_times_[location_id_1 * number_of_locations + location_id_2]
+                        != instance_.compute_travel_time(location_id_1, location_id_2)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     /** Read an instance from a file in 'chao1996' format. */
     void read_chao1996(
             std::ifstream& file)
@@ -445,6 +718,12 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Travel times, stored as a full matrix while building. */
+    std::vector<Time> travel_times_;
+
+    /** Requested storage mode of the travel times. */
+    TravelTimesStorage travel_times_storage_ = TravelTimesStorage::Full;
+
 };
 
 }
@@ -22,6 +22,7 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 
 #include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
@@ -66,6 +67,171 @@ struct Arc
     Length length;
 };
 
+/**
+ * Class for a piecewise-linear arrival time function.
+ *
+ * The function is defined by a list of breakpoints sorted by departure time.
+ * Between two breakpoints, the arrival time is linear; before the first
+ * breakpoint and after the last one, its slope is 1. Since the travel times
+ * satisfy the FIFO property, the function is strictly increasing, which makes
+ * it invertible and allows composing functions along a path.
+ *
+ * The class does not own its breakpoints; it is a view on a contiguous array
+ * of breakpoints which must outlive it.
+ */
+class ArrivalTimeFunction
+{
+
+public:
+
+    /** Structure for a breakpoint. */
+    struct Breakpoint
+    {
+        /** Departure time. */
+        Time departure_time;
+
+        /** Arrival time. */
+        Time arrival_time;
+
+        /** Slope of the function after the breakpoint. */
+        double slope;
+    };
+
+    /**
+     * Add a breakpoint at the end of a list of breakpoints.
+     *
+     * The departure time must be greater than the departure time of the last
+     * breakpoint of the list.
+     */
+    static void add_breakpoint(
+            std::vector<Breakpoint>& breakpoints,
+            Time departure_time,
+            Time arrival_time)
+    {
+        if (!breakpoints.empty()) {
+            Breakpoint& breakpoint = breakpoints.back();
+            breakpoint.slope
+                = (arrival_time - breakpoint.arrival_time)
+                / (departure_time - breakpoint.departure_time);
+        }
+        breakpoints.push_back({departure_time, arrival_time, 1.0});
+    }
+
+    /** Constructor of the identity function. */
+    ArrivalTimeFunction() { }
+
+    /** Constructor from an array of breakpoints. */
+    ArrivalTimeFunction(
+            const Breakpoint* breakpoints,
+            std::size_t number_of_breakpoints):
+        breakpoints_(breakpoints),
+        number_of_breakpoints_(number_of_breakpoints) { }
+
+    /** Constructor from a list of breakpoints. */
+    ArrivalTimeFunction(
+            const std::vector<Breakpoint>& breakpoints):
+        ArrivalTimeFunction(breakpoints.data(), breakpoints.size()) { }
+
+    /** Get the number of breakpoints. */
+    inline std::size_t number_of_breakpoints() const { return number_of_breakpoints_; }
+
+    /** Get a breakpoint. */
+    inline const Breakpoint& breakpoint(std::size_t pos) const { return breakpoints_[pos]; }
+
+    /**
+     * Get the arrival time for a given departure time.
+     *
+     * This method runs in O(log k) where k is the number of breakpoints.
+     */
+    inline Time arrival_time(Time departure_time) const
+    {
+        if (number_of_breakpoints_ == 0)
+            return departure_time;
+        const Breakpoint* it = std::upper_bound(
+                breakpoints_,
+                breakpoints_ + number_of_breakpoints_,
+                departure_time,
+                [](Time time, const Breakpoint& breakpoint) { return time < breakpoint.departure_time; });
+        if (it == breakpoints_)
+            return breakpoints_[0].arrival_time - breakpoints_[0].departure_time + departure_time;
+        --it;
+        return it->arrival_time + (departure_time - it->departure_time) * it->slope;
+    }
+
+    /**
+     * Get the departure time for a given arrival time.
+     *
+     * This method runs in O(log k) where k is the number of breakpoints.
+     */
+    inline Time departure_time(Time arrival_time) const
+    {
+        if (number_of_breakpoints_ == 0)
+            return arrival_time;
+        const Breakpoint* it = std::upper_bound(
+                breakpoints_,
+                breakpoints_ + number_of_breakpoints_,
+                arrival_time,
+                [](Time time, const Breakpoint& breakpoint) { return time < breakpoint.arrival_time; });
+        if (it == breakpoints_)
+            return breakpoints_[0].departure_time - breakpoints_[0].arrival_time + arrival_time;
+        --it;
+        return it->departure_time + (arrival_time - it->arrival_time) / it->slope;
+    }
+
+    /**
+     * Compose the function with the function of the next arc or path.
+     *
+     * The returned function 'h' satisfies 'h(t) = next(this(t))'. Its
+     * breakpoints are written into 'breakpoints', which is cleared first and
+     * must not hold the breakpoints of this function or of 'next'. Reusing
+     * the same buffers along a path avoids allocations.
+     *
+     * This method runs in O(k₁ + k₂) where k₁ and k₂ are the numbers of
+     * breakpoints of both functions.
+     */
+    ArrivalTimeFunction compose(
+            const ArrivalTimeFunction& next,
+            std::vector<Breakpoint>& breakpoints) const
+    {
+        breakpoints.clear();
+        std::size_t pos_1 = 0;
+        std::size_t pos_2 = 0;
+        while (pos_1 < number_of_breakpoints()
+                || pos_2 < next.number_of_breakpoints()) {
+            // Departure time of the next breakpoint of the composition.
+            Time time = std::numeric_limits<Time>::infinity();
+            if (pos_1 < number_of_breakpoints())
+                time = breakpoints_[pos_1].departure_time;
+            if (pos_2 < next.number_of_breakpoints()) {
+                Time time_2 = departure_time(next.breakpoints_[pos_2].departure_time);
+                if (time_2 <= time) {
+                    if (time_2 == time)
+                        pos_1++;
+                    time = time_2;
+                    pos_2++;
+                } else {
+                    pos_1++;
+                }
+            } else {
+                pos_1++;
+            }
+            if (!breakpoints.empty() && breakpoints.back().departure_time >= time)
+                continue;
+            add_breakpoint(breakpoints, time, next.arrival_time(arrival_time(time)));
+        }
+        return ArrivalTimeFunction(breakpoints);
+    }
+
+private:
+
+    /** Breakpoints. */
+    const Breakpoint* breakpoints_ = nullptr;
+
+    /** Number of breakpoints. */
+    std::size_t number_of_breakpoints_ = 0;
+
+};
+
 /**
  * Instance class for a 'time_dependent_orienteering' problem.
  */
@@ -96,43 +262,18 @@ public:
             LocationId location_id_2,
             Time start) const
     {
-        Time current_time = start;
-        Length remaining_length = arcs_[location_id_1][location_id_2].length;
-        ArcCategory arc_category = arcs_[location_id_1][location_id_2].category;
-        TimePeriod time_period =
-            (current_time < 9 - 7)? 0:
-            (current_time < 17 - 7)? 1:
-            (current_time < 19 - 7)? 2:
-            3;
-        for (;;) {
-            Time time_period_end =
-                (time_period == 0)? 9 - 7:
-                (time_period == 1)? 17 - 7:
-                (time_period == 2)? 19 - 7:
-                std::numeric_limits<Time>::max();
-            double speed = speed_matrix_[arc_category][time_period];
-            Time at = current_time + remaining_length / speed;
-            if (at <= time_period_end) {
-                //os << "location_id_1 " << location_id_1
-                //    << " location_id_2 " << location_id_2
-                //    << " x1 " << locations_[location_id_1].x
-                //    << " y1 " << locations_[location_id_1].y
-                //    << " x2 " << locations_[location_id_2].x
-                //    << " y2 " << locations_[location_id_2].y
-                //    << " length " << arcs_[location_id_1][location_id_2].length
-                //    << " cat " << arc_category
-                //    << " start " << start
-                //    << " dur " << at - start
-                //    << " arrival " << at << " / " << time_period_end
-                //    << std::endl;
-                return at;
-            }
-            remaining_length -= (time_period_end - current_time) * speed;
-            //os << "remaining_length " << remaining_length << std::endl;
-            current_time = time_period_end;
-            time_period++;
-        }
-        return -1;
+        return arrival_time_function(location_id_1, location_id_2).arrival_time(start);
+    }
+
+    /** Get the arrival time function of an arc. */
+    inline ArrivalTimeFunction arrival_time_function(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        LocationId arc_id = location_id_1 * number_of_locations() + location_id_2;
+        return ArrivalTimeFunction(
+                arrival_time_breakpoints_.data() + arrival_time_breakpoints_offsets_[arc_id],
+                arrival_time_breakpoints_offsets_[arc_id + 1] - arrival_time_breakpoints_offsets_[arc_id]);
     }
 
     /*
@@ -214,7 +355,7 @@ public:
             }
             locations.add(location_id);
 
-            current_time = arrival_time(
+            current_time = compute_arrival_time(
                     location_id_prev,
                     location_id,
                     current_time);
@@ -231,7 +372,7 @@ public:
 
             location_id_prev = location_id;
         }
-        current_time = arrival_time(location_id_prev, number_of_locations() - 1, current_time);
+        current_time = compute_arrival_time(location_id_prev, number_of_locations() - 1, current_time);
         profit += location(number_of_locations() - 1).profit;
 
         if (verbosity_level >= 2) {
@@ -268,6 +409,109 @@ private:
     /** Constructor to build an instance manually. */
     Instance() { }
 
+    /**
+     * Compute the arrival time at a location depending on the departure
+     * location and the departure time by going through the time periods.
+     */
+    Time compute_arrival_time(
+            LocationId location_id_1,
+            LocationId location_id_2,
+            Time start) const
+    {
+        Time current_time = start;
+        Length remaining_length = arcs_[location_id_1][location_id_2].length;
+        ArcCategory arc_category = arcs_[location_id_1][location_id_2].category;
+        TimePeriod time_period =
+            (current_time < 9 - 7)? 0:
+            (current_time < 17 - 7)? 1:
+            (current_time < 19 - 7)? 2:
+            3;
+        for (;;) {
+            Time time_period_end =
+                (time_period == 0)? 9 - 7:
+                (time_period == 1)? 17 - 7:
+                (time_period == 2)? 19 - 7:
+                std::numeric_limits<Time>::max();
+            double speed = speed_matrix_[arc_category][time_period];
+            Time at = current_time + remaining_length / speed;
+            if (at <= time_period_end)
+                return at;
+            remaining_length -= (time_period_end - current_time) * speed;
+            current_time = time_period_end;
+            time_period++;
+        }
+        return -1;
+    }
+
+    /**
+     * Compute the departure time from a location depending on the arrival
+     * location and the arrival time by going backward through the time
+     * periods.
+     */
+    Time compute_departure_time(
+            LocationId location_id_1,
+            LocationId location_id_2,
+            Time end) const
+    {
+        Time current_time = end;
+        Length remaining_length = arcs_[location_id_1][location_id_2].length;
+        ArcCategory arc_category = arcs_[location_id_1][location_id_2].category;
+        TimePeriod time_period =
+            (current_time <= 9 - 7)? 0:
+            (current_time <= 17 - 7)? 1:
+            (current_time <= 19 - 7)? 2:
+            3;
+        for (;;) {
+            Time time_period_start =
+                (time_period == 0)? -std::numeric_limits<Time>::infinity():
+                (time_period == 1)? 9 - 7:
+                (time_period == 2)? 17 - 7:
+                19 - 7;
+            double speed = speed_matrix_[arc_category][time_period];
+            Time dt = current_time - remaining_length / speed;
+            if (dt >= time_period_start)
+                return dt;
+            remaining_length -= (current_time - time_period_start) * speed;
+            current_time = time_period_start;
+            time_period--;
+        }
+        return -1;
+    }
+
+    /**
+     * Compute the breakpoints of the arrival time function of an arc.
+     *
+     * The breakpoints are written into 'breakpoints', which is cleared first.
+     */
+    void compute_arrival_time_function(
+            LocationId location_id_1,
+            LocationId location_id_2,
+            std::vector<ArrivalTimeFunction::Breakpoint>& breakpoints) const
+    {
+        // The slope of the arrival time function changes when the departure
+        // or the arrival crosses the end of a time period.
+        std::vector<Time> departure_times;
+        for (Time time_period_end: {9 - 7, 17 - 7, 19 - 7}) {
+            departure_times.push_back(time_period_end);
+            departure_times.push_back(compute_departure_time(
+                        location_id_1,
+                        location_id_2,
+                        time_period_end));
+        }
+        std::sort(departure_times.begin(), departure_times.end());
+        departure_times.erase(
+                std::unique(departure_times.begin(), departure_times.end()),
+                departure_times.end());
+
+        breakpoints.clear();
+        for (Time departure_time: departure_times) {
+            ArrivalTimeFunction::add_breakpoint(
+                    breakpoints,
+                    departure_time,
+                    compute_arrival_time(location_id_1, location_id_2, departure_time));
+        }
+    }
+
     /*
      * Private attributes
      */
@@ -284,6 +528,22 @@ private:
     /** Maximum duration. */
     Time maximum_duration_ = 0;
 
+    /*
+     * Computed attributes
+     */
+
+    /**
+     * Breakpoints of the arrival time functions of all arcs.
+     *
+     * The breakpoints of arc 'location_id_1 * n + location_id_2' are stored
+     * between positions 'arrival_time_breakpoints_offsets_[arc_id]' and
+     * 'arrival_time_breakpoints_offsets_[arc_id + 1]'.
+     */
+    std::vector<ArrivalTimeFunction::Breakpoint> arrival_time_breakpoints_;
+
+    /** Offsets of the breakpoints of each arc. */
+    std::vector<std::size_t> arrival_time_breakpoints_offsets_;
+
     friend class InstanceBuilder;
 };
 
@@ -385,6 +645,33 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        // Compute arrival time functions.
+        LocationId number_of_locations = instance_.number_of_locations();
+        std::vector<ArrivalTimeFunction::Breakpoint> breakpoints;
+        instance_.arrival_time_breakpoints_.clear();
+        instance_.arrival_time_breakpoints_offsets_.clear();
+        instance_.arrival_time_breakpoints_offsets_.reserve(
+                number_of_locations * number_of_locations + 1);
+        instance_.arrival_time_breakpoints_offsets_.push_back(0);
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = 0;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                instance_.compute_arrival_time_function(
+                        location_id_1,
+                        location_id_2,
+                        breakpoints);
+                instance_.arrival_time_breakpoints_.insert(
+                        instance_.arrival_time_breakpoints_.end(),
+                        breakpoints.begin(),
+                        breakpoints.end());
+                instance_.arrival_time_breakpoints_offsets_.push_back(
+                        instance_.arrival_time_breakpoints_.size());
+            }
+        }
+
         return std::move(instance_);
     }
 
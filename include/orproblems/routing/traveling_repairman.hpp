@@ -19,6 +19,9 @@
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 
 namespace orproblems
 {
@@ -41,6 +44,32 @@ struct Location
     double y;
 };
 
+/**
+ * Enumeration of the storage modes of the travel times.
+ */
+enum class TravelTimesStorage
+{
+    /** Full n×n matrix. */
+    Full,
+
+    /** Upper triangle of a symmetric matrix. */
+    Symmetric,
+
+    /**
+     * Upper triangle of a symmetric matrix, in single precision.
+     *
+     * Travel times are rounded to the nearest 'float' for 'travel_time'. This
+     * mode is only used if the exact travel times can still be recovered,
+     * i.e. if they are exactly representable as 'float' or if they are equal
+     * to the ones computed from the coordinates; otherwise, 'Symmetric' is
+     * used. 'exact_travel_time' always returns the exact travel times.
+     */
+    SymmetricFloat,
+
+    /** Travel times computed on demand from the coordinates of the locations. */
+    Coordinates,
+};
+
 /**
  * Instance class for a 'traveling_repairman' problem.
  */
@@ -54,14 +83,90 @@ public:
      */
 
     /** Get the number of locations. */
-    inline LocationId number_of_locations() const { return travel_times_.size(); }
+    inline LocationId number_of_locations() const { return locations_.size(); }
+
+    /** Get the storage mode of the travel times. */
+    inline TravelTimesStorage travel_times_storage() const { return travel_times_storage_; }
+
+    /**
+     * Get the travel time between two locations for a given storage mode.
+     *
+     * The storage mode must be the one of the instance. Since it is known at
+     * compile time, this method doesn't branch on it.
+     */
+    template <TravelTimesStorage travel_times_storage>
+    inline Time travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        if (travel_times_storage == TravelTimesStorage::Full) {
+            return travel_times_[location_id_1 * number_of_locations() + location_id_2];
+        } else if (travel_times_storage == TravelTimesStorage::Symmetric) {
+            return travel_times_[symmetric_index(location_id_1, location_id_2)];
+        } else if (travel_times_storage == TravelTimesStorage::SymmetricFloat) {
+            return travel_times_float_[symmetric_index(location_id_1, location_id_2)];
+        } else {
+            if (location_id_1 == location_id_2)
+                return travel_times_[location_id_1];
+            return compute_travel_time(location_id_1, location_id_2);
+        }
+    }
+
+    /**
+     * Call a function with the storage mode of the travel times as a
+     * compile-time constant.
+     *
+     * The function receives a 'std::integral_constant<TravelTimesStorage, S>'
+     * and can call 'travel_time<S>()' without branching on the storage mode.
+     */
+    template <typename Function>
+    inline auto visit_travel_times_storage(Function function) const
+    {
+        if (travel_times_storage_ == TravelTimesStorage::Full) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Full>());
+        } else if (travel_times_storage_ == TravelTimesStorage::Symmetric) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Symmetric>());
+        } else if (travel_times_storage_ == TravelTimesStorage::SymmetricFloat) {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::SymmetricFloat>());
+        } else {
+            return function(std::integral_constant<TravelTimesStorage, TravelTimesStorage::Coordinates>());
+        }
+    }
 
-    /** Get the travel time between two locations. */
+    /**
+     * Get the travel time between two locations.
+     *
+     * This method dispatches on the storage mode at each call. In hot loops,
+     * prefer dispatching once with 'visit_travel_times_storage'.
+     */
     inline Time travel_time(
             LocationId location_id_1,
             LocationId location_id_2) const
     {
-        return travel_times_[location_id_1][location_id_2];
+        return visit_travel_times_storage(
+                [this, location_id_1, location_id_2](auto storage)
+                {
+                    return this->travel_time<decltype(storage)::value>(
+                            location_id_1,
+                            location_id_2);
+                });
+    }
+
+    /**
+     * Get the exact travel time between two locations.
+     *
+     * It differs from 'travel_time' only with the 'SymmetricFloat' storage
+     * mode, if the travel times are not exactly representable as 'float'.
+     */
+    inline Time exact_travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        if (!exact_travel_times_from_coordinates_)
+            return travel_time(location_id_1, location_id_2);
+        if (location_id_1 == location_id_2)
+            return travel_times_[location_id_1];
+        return compute_travel_time(location_id_1, location_id_2);
     }
 
     /*
@@ -144,7 +249,7 @@ public:
             }
             locations.add(location_id);
 
-            current_time += travel_time(location_id_prev, location_id);
+            current_time += exact_travel_time(location_id_prev, location_id);
             total_completion_time += current_time;
 
             if (verbosity_level >= 2) {
@@ -184,6 +289,29 @@ private:
     /** Constructor to build an instance manually. */
     Instance() { }
 
+    /**
+     * Get the index of the travel time between two locations in the upper
+     * triangle storage.
+     */
+    inline std::size_t symmetric_index(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        std::size_t i = std::min(location_id_1, location_id_2);
+        std::size_t j = std::max(location_id_1, location_id_2);
+        return i * (2 * number_of_locations() - i + 1) / 2 + (j - i);
+    }
+
+    /** Compute the travel time between two locations from their coordinates. */
+    inline Time compute_travel_time(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        Time dx = locations_[location_id_1].x - locations_[location_id_2].x;
+        Time dy = locations_[location_id_1].y - locations_[location_id_2].y;
+        return std::floor(std::sqrt(dx * dx + dy * dy));
+    }
+
     /*
      * Private attributes
      */
@@ -191,8 +319,27 @@ private:
     /** Locations. */
     std::vector<Location> locations_;
 
-    /** Travel times. */
-    std::vector<std::vector<Time>> travel_times_;
+    /** Storage mode of the travel times. */
+    TravelTimesStorage travel_times_storage_ = TravelTimesStorage::Full;
+
+    /**
+     * Travel times.
+     *
+     * Depending on the storage mode, it contains the full matrix, its upper
+     * triangle or only its diagonal.
+     */
+    std::vector<Time> travel_times_;
+
+    /** Travel times in single precision. */
+    std::vector<float> travel_times_float_;
+
+    /**
+     * 'true' iff the travel times are stored in single precision but are not
+     * exactly representable as 'float'. The exact travel times are then
+     * computed from the coordinates, and 'travel_times_' contains the
+     * diagonal of the matrix.
+     */
+    bool exact_travel_times_from_coordinates_ = false;
 
     friend class InstanceBuilder;
 };
@@ -213,9 +360,7 @@ public:
     void set_number_of_locations(LocationId number_of_locations)
     {
         instance_.locations_ = std::vector<Location>(number_of_locations),
-        instance_.travel_times_ = std::vector<std::vector<Time>>(
-                number_of_locations,
-                std::vector<Time>(number_of_locations, -1));
+        travel_times_ = std::vector<Time>(number_of_locations * number_of_locations, -1);
     }
 
     /** Set the coordinates of a location. */
@@ -234,9 +379,21 @@ public:
             LocationId location_id_2,
             Time travel_time)
     {
-        instance_.travel_times_[location_id_1][location_id_2] = travel_time;
+        travel_times_[location_id_1 * instance_.number_of_locations() + location_id_2] = travel_time;
     }
 
+    /**
+     * Set the storage mode of the travel times.
+     *
+     * If the travel times are not symmetric or don't match the coordinates,
+     * a more general storage mode is used when building the instance.
+     * 'SymmetricFloat' is used if the travel times are exactly representable
+     * as 'float' or match the coordinates; in the latter case, 'travel_time'
+     * returns travel times rounded to single precision, while 'check' uses
+     * the exact ones.
+     */
+    void set_travel_times_storage(TravelTimesStorage travel_times_storage) { travel_times_storage_ = travel_times_storage; }
+
     /** Build an instance from a file. */
     void read(
             const std::string& instance_path,
@@ -263,6 +420,69 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        // Select the storage mode of the travel times.
+        TravelTimesStorage travel_times_storage = travel_times_storage_;
+        if (travel_times_storage == TravelTimesStorage::Coordinates
+                && !travel_times_match_coordinates()) {
+            travel_times_storage = TravelTimesStorage::Full;
+        }
+        if ((travel_times_storage == TravelTimesStorage::Symmetric
+                    || travel_times_storage == TravelTimesStorage::SymmetricFloat)
+                && !travel_times_are_symmetric()) {
+            travel_times_storage = TravelTimesStorage::Full;
+        }
+        bool exact_travel_times_from_coordinates = false;
+        if (travel_times_storage == TravelTimesStorage::SymmetricFloat
+                && !travel_times_fit_in_float()) {
+            if (travel_times_match_coordinates()) {
+                exact_travel_times_from_coordinates = true;
+            } else {
+                travel_times_storage = TravelTimesStorage::Symmetric;
+            }
+        }
+        instance_.travel_times_storage_ = travel_times_storage;
+        instance_.exact_travel_times_from_coordinates_ = exact_travel_times_from_coordinates;
+
+        // Store travel times.
+        LocationId number_of_locations = instance_.number_of_locations();
+        instance_.travel_times_.clear();
+        instance_.travel_times_float_.clear();
+        if (travel_times_storage == TravelTimesStorage::Full) {
+            instance_.travel_times_ = std::move(travel_times_);
+        } else if (travel_times_storage == TravelTimesStorage::Symmetric
+                || travel_times_storage == TravelTimesStorage::SymmetricFloat) {
+            for (LocationId location_id_1 = 0;
+                    location_id_1 < number_of_locations;
+                    ++location_id_1) {
+                for (LocationId location_id_2 = location_id_1;
+                        location_id_2 < number_of_locations;
+                        ++location_id_2) {
+                    Time travel_time = travel_times_[location_id_1 * number_of_locations + location_id_2];
+                    if (travel_times_storage == TravelTimesStorage::Symmetric) {
+                        instance_.travel_times_.push_back(travel_time);
+                    } else {
+                        instance_.travel_times_float_.push_back(travel_time);
+                    }
+                }
+            }
+            if (exact_travel_times_from_coordinates) {
+                for (LocationId location_id = 0;
+                        location_id < number_of_locations;
+                        ++location_id) {
+                    instance_.travel_times_.push_back(
+                            travel_times_[location_id * number_of_locations + location_id]);
+                }
+            }
+        } else {
+            for (LocationId location_id = 0;
+                    location_id < number_of_locations;
+                    ++location_id) {
+                instance_.travel_times_.push_back(
+                        travel_times_[location_id * number_of_locations + location_id]);
+            }
+        }
+        travel_times_.clear();
+
         return std::move(instance_);
     }
 
@@ -272,6 +492,58 @@ private:
      * Private methods
      */
 
+    /** Return 'true' iff the travel time matrix is symmetric. */
+    bool travel_times_are_symmetric() const
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = location_id_1 + 1;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                if (travel_times_[location_id_1 * number_of_locations + location_id_2]
+                        != travel_times_[location_id_2 * number_of_locations + location_id_1]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /** Return 'true' iff all travel times are exactly representable as 'float'. */
+    bool travel_times_fit_in_float() const
+    {
+        for (Time travel_time: travel_times_)
+            if ((Time)(float)travel_time != travel_time)
+                return false;
+        return true;
+    }
+
+    /**
+     * Return 'true' iff all travel times between different locations are
+     * equal to the ones computed from the coordinates.
+     */
+    bool travel_times_match_coordinates() const
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+        for (LocationId location_id_1 = 0;
+                location_id_1 < number_of_locations;
+                ++location_id_1) {
+            for (LocationId location_id_2 = 0;
+                    location_id_2 < number_of_locations;
+                    ++location_id_2) {
+                if (location_id_1 == location_id_2)
+                    continue;
+                if (travel_times_[location_id_1 * number_of_locations + location_id_2]
+                        != instance_.compute_travel_time(location_id_1, location_id_2)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
     /** Read an instance from a file in 'salehipour2011' format. */
     void read_salehipour2011(std::ifstream& file)
     {
@@ -284,23 +556,25 @@ private:
             >> number_of_locations
             >> tmp >> tmp >> tmp >> tmp >> tmp >> tmp >> tmp >> tmp >> tmp
             ;
+        // The number of locations in the file doesn't include the depot.
+        number_of_locations++;
         set_number_of_locations(number_of_locations);
 
         // Read location coordinates.
         double x = -1;
         double y = -1;
         for (LocationId location_id = 0;
-                location_id < number_of_locations + 1;
+                location_id < number_of_locations;
                 ++location_id) {
             file >> tmp >> x >> y;
             set_location_coordinates(location_id, x, y);
         }
 
         for (LocationId location_id_1 = 0;
-                location_id_1 < number_of_locations + 1;
+                location_id_1 < number_of_locations;
                 ++location_id_1) {
             for (LocationId location_id_2 = 0;
-                    location_id_2 < number_of_locations + 1;
+                    location_id_2 < number_of_locations;
                     ++location_id_2) {
                 Time dx = instance_.locations_[location_id_1].x - instance_.locations_[location_id_2].x;
                 Time dy = instance_.locations_[location_id_1].y - instance_.locations_[location_id_2].y;
@@ -317,6 +591,323 @@ private:
     /** Instance. */
     Instance instance_;
 
+    /** Travel times, stored as a full matrix while building. */
+    std::vector<Time> travel_times_;
+
+    /** Requested storage mode of the travel times. */
+    TravelTimesStorage travel_times_storage_ = TravelTimesStorage::Full;
+
+};
+
+/**
+ * Evaluator of the neighborhoods of a tour of a 'traveling_repairman'
+ * problem.
+ *
+ * Moving a location changes the arrival time of every later location, so a
+ * direct evaluation of a move takes O(n). Following Silva et al. (2012), the
+ * evaluator stores, for each subsequence σ of consecutive positions of the
+ * tour, in both directions:
+ * - its duration T(σ)
+ * - its cost C(σ), the sum of the arrival times at its customers if it starts
+ *   at time 0
+ * The number of customers W(σ) of a subsequence follows from its positions.
+ * The concatenation of two subsequences σ₁ ⊕ σ₂ satisfies
+ *     T(σ₁ ⊕ σ₂) = T(σ₁) + t(last(σ₁), first(σ₂)) + T(σ₂)
+ *     C(σ₁ ⊕ σ₂) = C(σ₁) + W(σ₂) (T(σ₁) + t(last(σ₁), first(σ₂))) + C(σ₂)
+ * Since the tour resulting from a 2-opt, or-opt or swap move is the
+ * concatenation of at most 5 subsequences of the current tour, these moves
+ * are evaluated in O(1).
+ *
+ * Setting a tour takes O(n²) time and memory.
+ *
+ * With the 'SymmetricFloat' storage mode, the travel times used are rounded
+ * to single precision, so the results are approximate.
+ */
+class TourEvaluator
+{
+
+public:
+
+    /** Constructor. */
+    TourEvaluator(const Instance& instance):
+        instance_(instance)
+    { }
+
+    /**
+     * Set the tour.
+     *
+     * The tour contains each location except location 0 once.
+     */
+    void set_tour(const std::vector<LocationId>& tour)
+    {
+        LocationPos n = tour.size() + 1;
+        tour_.resize(n);
+        tour_[0] = 0;
+        std::copy(tour.begin(), tour.end(), tour_.begin() + 1);
+        instance_.visit_travel_times_storage(
+                [this](auto storage)
+                {
+                    this->compute_subsequences<decltype(storage)::value>();
+                });
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of positions of the tour, including location 0. */
+    inline LocationPos number_of_positions() const { return tour_.size(); }
+
+    /** Get the location at a position of the tour. */
+    inline LocationId location_id(LocationPos pos) const { return tour_[pos]; }
+
+    /** Get the total completion time of the tour. */
+    inline Time total_completion_time() const { return subsequences_[number_of_positions() - 1].cost; }
+
+    /*
+     * Moves
+     *
+     * Positions are positions in the tour, location 0 being at position 0.
+     * Each method returns the difference between the total completion time
+     * of the tour after the move and the current one.
+     */
+
+    /**
+     * Evaluate the reversal of the positions pos_1..pos_2, with
+     * 1 <= pos_1 < pos_2.
+     */
+    inline Time two_opt(
+            LocationPos pos_1,
+            LocationPos pos_2) const
+    {
+        return instance_.visit_travel_times_storage(
+                [this, pos_1, pos_2](auto storage)
+                {
+                    return this->two_opt<decltype(storage)::value>(pos_1, pos_2);
+                });
+    }
+
+    /**
+     * Evaluate moving the positions pos_first..pos_last right after position
+     * pos, with pos < pos_first - 1 or pos > pos_last.
+     *
+     * If 'reversed' is 'true', the moved positions are reversed.
+     */
+    inline Time or_opt(
+            LocationPos pos_first,
+            LocationPos pos_last,
+            LocationPos pos,
+            bool reversed = false) const
+    {
+        return instance_.visit_travel_times_storage(
+                [this, pos_first, pos_last, pos, reversed](auto storage)
+                {
+                    return this->or_opt<decltype(storage)::value>(
+                            pos_first,
+                            pos_last,
+                            pos,
+                            reversed);
+                });
+    }
+
+    /**
+     * Evaluate swapping the locations at positions pos_1 and pos_2, with
+     * 1 <= pos_1 < pos_2.
+     */
+    inline Time swap(
+            LocationPos pos_1,
+            LocationPos pos_2) const
+    {
+        return instance_.visit_travel_times_storage(
+                [this, pos_1, pos_2](auto storage)
+                {
+                    return this->swap<decltype(storage)::value>(pos_1, pos_2);
+                });
+    }
+
+private:
+
+    /** Structure for the stored data of a subsequence. */
+    struct SubsequenceData
+    {
+        /** Duration. */
+        Time duration;
+
+        /** Sum of the arrival times at the customers if it starts at time 0. */
+        Time cost;
+    };
+
+    /** Structure for a subsequence. */
+    struct Subsequence
+    {
+        /** First location, '-1' if the subsequence is empty. */
+        LocationId first;
+
+        /** Last location. */
+        LocationId last;
+
+        /** Number of customers. */
+        LocationPos number_of_customers;
+
+        /** Duration and cost. */
+        SubsequenceData data;
+    };
+
+    /*
+     * Private methods
+     *
+     * The methods templated on the storage mode of the travel times don't
+     * branch on it.
+     */
+
+    /** Compute the data of all subsequences of the tour. */
+    template <TravelTimesStorage travel_times_storage>
+    void compute_subsequences()
+    {
+        LocationPos n = number_of_positions();
+        subsequences_.resize(n * n);
+        for (LocationPos pos_1 = 0; pos_1 < n; ++pos_1) {
+            subsequences_[pos_1 * n + pos_1] = {0, 0};
+            for (LocationPos pos_2 = pos_1 + 1; pos_2 < n; ++pos_2) {
+                // Forward subsequence pos_1..pos_2.
+                subsequences_[pos_1 * n + pos_2] = concatenate<travel_times_storage>(
+                        subsequence(pos_1, pos_2 - 1),
+                        subsequence(pos_2, pos_2)).data;
+            }
+        }
+        for (LocationPos pos_1 = n - 1; pos_1 >= 0; --pos_1) {
+            for (LocationPos pos_2 = pos_1 - 1; pos_2 >= 0; --pos_2) {
+                // Backward subsequence pos_1..pos_2.
+                subsequences_[pos_1 * n + pos_2] = concatenate<travel_times_storage>(
+                        subsequence(pos_2 + 1, pos_1, true),
+                        subsequence(pos_2, pos_2)).data;
+            }
+        }
+    }
+
+    /** Evaluate a 2-opt move. */
+    template <TravelTimesStorage travel_times_storage>
+    inline Time two_opt(
+            LocationPos pos_1,
+            LocationPos pos_2) const
+    {
+        return concatenate<travel_times_storage>(
+                concatenate<travel_times_storage>(
+                    subsequence(0, pos_1 - 1),
+                    subsequence(pos_1, pos_2, true)),
+                subsequence(pos_2 + 1, number_of_positions() - 1)).data.cost
+            - total_completion_time();
+    }
+
+    /** Evaluate an or-opt move. */
+    template <TravelTimesStorage travel_times_storage>
+    inline Time or_opt(
+            LocationPos pos_first,
+            LocationPos pos_last,
+            LocationPos pos,
+            bool reversed) const
+    {
+        Subsequence block = subsequence(pos_first, pos_last, reversed);
+        if (pos < pos_first) {
+            return concatenate<travel_times_storage>(
+                    concatenate<travel_times_storage>(
+                        concatenate<travel_times_storage>(
+                            subsequence(0, pos),
+                            block),
+                        subsequence(pos + 1, pos_first - 1)),
+                    subsequence(pos_last + 1, number_of_positions() - 1)).data.cost
+                - total_completion_time();
+        } else {
+            return concatenate<travel_times_storage>(
+                    concatenate<travel_times_storage>(
+                        concatenate<travel_times_storage>(
+                            subsequence(0, pos_first - 1),
+                            subsequence(pos_last + 1, pos)),
+                        block),
+                    subsequence(pos + 1, number_of_positions() - 1)).data.cost
+                - total_completion_time();
+        }
+    }
+
+    /** Evaluate a swap move. */
+    template <TravelTimesStorage travel_times_storage>
+    inline Time swap(
+            LocationPos pos_1,
+            LocationPos pos_2) const
+    {
+        return concatenate<travel_times_storage>(
+                concatenate<travel_times_storage>(
+                    concatenate<travel_times_storage>(
+                        concatenate<travel_times_storage>(
+                            subsequence(0, pos_1 - 1),
+                            subsequence(pos_2, pos_2)),
+                        subsequence(pos_1 + 1, pos_2 - 1)),
+                    subsequence(pos_1, pos_1)),
+                subsequence(pos_2 + 1, number_of_positions() - 1)).data.cost
+            - total_completion_time();
+    }
+
+    /**
+     * Get the subsequence of the positions pos_first..pos_last.
+     *
+     * The subsequence is empty if pos_first > pos_last. If 'reversed' is
+     * 'true', it is traversed backward.
+     */
+    inline Subsequence subsequence(
+            LocationPos pos_first,
+            LocationPos pos_last,
+            bool reversed = false) const
+    {
+        if (pos_first > pos_last)
+            return {-1, -1, 0, {0, 0}};
+        LocationPos pos_1 = (!reversed)? pos_first: pos_last;
+        LocationPos pos_2 = (!reversed)? pos_last: pos_first;
+        return {
+            tour_[pos_1],
+            tour_[pos_2],
+            pos_last - pos_first + ((pos_first == 0)? 0: 1),
+            subsequences_[pos_1 * number_of_positions() + pos_2]};
+    }
+
+    /** Concatenate two subsequences. */
+    template <TravelTimesStorage travel_times_storage>
+    inline Subsequence concatenate(
+            const Subsequence& subsequence_1,
+            const Subsequence& subsequence_2) const
+    {
+        if (subsequence_1.first == -1)
+            return subsequence_2;
+        if (subsequence_2.first == -1)
+            return subsequence_1;
+        Time start = subsequence_1.data.duration
+            + instance_.travel_time<travel_times_storage>(subsequence_1.last, subsequence_2.first);
+        return {
+            subsequence_1.first,
+            subsequence_2.last,
+            subsequence_1.number_of_customers + subsequence_2.number_of_customers,
+            {
+                start + subsequence_2.data.duration,
+                subsequence_1.data.cost
+                    + subsequence_2.number_of_customers * start
+                    + subsequence_2.data.cost}};
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Tour, starting with location 0. */
+    std::vector<LocationId> tour_;
+
+    /**
+     * Data of the subsequences; 'subsequences_[pos_1 * n + pos_2]' contains
+     * the data of the subsequence from position pos_1 to position pos_2.
+     */
+    std::vector<SubsequenceData> subsequences_;
+
 };
 
 }
@@ -19,9 +19,15 @@
 #include "optimizationtools/containers/indexed_set.hpp"
 #include "optimizationtools/utils/utils.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <thread>
 
 namespace orproblems
 {
@@ -366,7 +372,7 @@ public:
                     ++location_id_2) {
                 instance_.maximum_travel_time_ = std::max(
                         instance_.maximum_travel_time_,
-                        instance_.travel_time(location_id_2, location_id_1));
+                        instance_.travel_time(location_id_1, location_id_2));
             }
         }
 
@@ -462,6 +468,69 @@ private:
         }
     }
 
+    /**
+     * Compute the travel times between each pair of distinct locations from a
+     * symmetric distance function.
+     *
+     * The upper triangle of the matrix is processed by square tiles, so that
+     * the rows written by the symmetric assignments of a tile remain in cache.
+     *
+     * The rows of tiles are shared among 'std::thread::hardware_concurrency()'
+     * threads. Each cell of the matrix is written by the row of tiles
+     * containing it or its symmetric cell in the upper triangle, so the
+     * threads write disjoint cells. The distance function must be safe to
+     * call concurrently.
+     */
+    template <typename DistanceFunction>
+    void compute_travel_times(const DistanceFunction& distance)
+    {
+        const LocationId tile_size = 64;
+        LocationId number_of_locations = instance_.number_of_locations();
+        LocationId number_of_tile_rows = (number_of_locations + tile_size - 1) / tile_size;
+        std::vector<std::vector<Time>>& travel_times = instance_.travel_times_;
+
+        // The first rows of tiles are the longest ones, so they are assigned
+        // dynamically to balance the load between the threads.
+        std::atomic<LocationId> next_tile_row(0);
+        auto compute_tile_rows = [&]()
+        {
+            for (;;) {
+                LocationId tile_row = next_tile_row++;
+                if (tile_row >= number_of_tile_rows)
+                    return;
+                LocationId tile_first_1 = tile_row * tile_size;
+                LocationId tile_end_1 = std::min(tile_first_1 + tile_size, number_of_locations);
+                for (LocationId tile_first_2 = tile_first_1;
+                        tile_first_2 < number_of_locations;
+                        tile_first_2 += tile_size) {
+                    LocationId tile_end_2 = std::min(tile_first_2 + tile_size, number_of_locations);
+                    for (LocationId location_id_1 = tile_first_1;
+                            location_id_1 < tile_end_1;
+                            ++location_id_1) {
+                        Time* row = travel_times[location_id_1].data();
+                        for (LocationId location_id_2 = std::max(tile_first_2, location_id_1 + 1);
+                                location_id_2 < tile_end_2;
+                                ++location_id_2) {
+                            Time travel_time = distance(location_id_1, location_id_2);
+                            row[location_id_2] = travel_time;
+                            travel_times[location_id_2][location_id_1] = travel_time;
+                        }
+                    }
+                }
+            }
+        };
+
+        LocationId number_of_threads = std::min(
+                std::max((LocationId)std::thread::hardware_concurrency(), (LocationId)1),
+                number_of_tile_rows);
+        std::vector<std::thread> threads;
+        for (LocationId thread_id = 1; thread_id < number_of_threads; ++thread_id)
+            threads.push_back(std::thread(compute_tile_rows));
+        compute_tile_rows();
+        for (std::thread& thread: threads)
+            thread.join();
+    }
+
     /** Read an instance from a file in 'archetti2018_atsplib' format. */
     void read_archetti2018_atsplib(std::ifstream& file)
     {
@@ -611,76 +680,97 @@ private:
         }
 
         // Compute travel times.
+        std::vector<double> xs(number_of_locations);
+        std::vector<double> ys(number_of_locations);
+        for (LocationId location_id = 0;
+                location_id < number_of_locations;
+                ++location_id) {
+            xs[location_id] = instance_.x(location_id);
+            ys[location_id] = instance_.y(location_id);
+        }
         if (edge_weight_type == "EUC_2D") {
-            for (LocationId location_id_1 = 0;
-                    location_id_1 < number_of_locations;
-                    ++location_id_1) {
-                for (LocationId location_id_2 = location_id_1 + 1;
-                        location_id_2 < number_of_locations;
-                        ++location_id_2) {
-                    double xd = instance_.x(location_id_2) - instance_.x(location_id_1);
-                    double yd = instance_.y(location_id_2) - instance_.y(location_id_1);
-                    Time d = std::round(std::sqrt(xd * xd + yd * yd));
-                    set_travel_time(location_id_1, location_id_2, d);
-                }
-            }
+            compute_travel_times(
+                    [&xs, &ys](LocationId location_id_1, LocationId location_id_2)
+                    {
+                        double xd = xs[location_id_2] - xs[location_id_1];
+                        double yd = ys[location_id_2] - ys[location_id_1];
+                        return (Time)std::round(std::sqrt(xd * xd + yd * yd));
+                    });
         } else if (edge_weight_type == "CEIL_2D") {
-            for (LocationId location_id_1 = 0;
-                    location_id_1 < number_of_locations;
-                    ++location_id_1) {
-                for (LocationId location_id_2 = location_id_1 + 1;
-                        location_id_2 < number_of_locations;
-                        ++location_id_2) {
-                    double xd = instance_.x(location_id_2) - instance_.x(location_id_1);
-                    double yd = instance_.y(location_id_2) - instance_.y(location_id_1);
-                    Time d = std::ceil(std::sqrt(xd * xd + yd * yd));
-                    set_travel_time(location_id_1, location_id_2, d);
-                }
-            }
+            compute_travel_times(
+                    [&xs, &ys](LocationId location_id_1, LocationId location_id_2)
+                    {
+                        double xd = xs[location_id_2] - xs[location_id_1];
+                        double yd = ys[location_id_2] - ys[location_id_1];
+                        return (Time)std::ceil(std::sqrt(xd * xd + yd * yd));
+                    });
         } else if (edge_weight_type == "GEO") {
             std::vector<double> latitudes(number_of_locations, 0);
             std::vector<double> longitudes(number_of_locations, 0);
             for (LocationId j = 0; j < number_of_locations; ++j) {
                 double pi = 3.141592;
-                int deg_x = std::round(instance_.x(j));
-                double min_x = instance_.x(j) - deg_x;
+                int deg_x = std::round(xs[j]);
+                double min_x = xs[j] - deg_x;
                 latitudes[j] = pi * (deg_x + 5.0 * min_x / 3.0) / 180.0;
-                int deg_y = std::round(instance_.y(j));
-                double min_y = instance_.y(j) - deg_y;
+                int deg_y = std::round(ys[j]);
+                double min_y = ys[j] - deg_y;
                 longitudes[j] = pi * (deg_y + 5.0 * min_y / 3.0) / 180.0;
             }
             double rrr = 6378.388;
-            for (LocationId location_id_1 = 0;
-                    location_id_1 < number_of_locations;
-                    ++location_id_1) {
-                for (LocationId location_id_2 = location_id_1 + 1;
-                        location_id_2 < number_of_locations;
-                        ++location_id_2) {
-                    double q1 = cos(longitudes[location_id_1] - longitudes[location_id_2]);
-                    double q2 = cos(latitudes[location_id_1] - latitudes[location_id_2]);
-                    double q3 = cos(latitudes[location_id_1] + latitudes[location_id_2]);
-                    Time travel_time = (Time)(rrr * acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0);
-                    set_travel_time(
-                            location_id_1,
-                            location_id_2,
-                            travel_time);
-                }
+            auto geo_distance = [&latitudes, &longitudes, rrr](LocationId location_id_1, LocationId location_id_2)
+            {
+                double q1 = cos(longitudes[location_id_1] - longitudes[location_id_2]);
+                double q2 = cos(latitudes[location_id_1] - latitudes[location_id_2]);
+                double q3 = cos(latitudes[location_id_1] + latitudes[location_id_2]);
+                return rrr * acos(0.5 * ((1.0 + q1) * q2 - (1.0 - q1) * q3)) + 1.0;
+            };
+
+            // Since 0.5 ((1 + q1) q2 - (1 - q1) q3) is equal to
+            // sin(lat1) sin(lat2) + cos(lat1) cos(lat2) cos(lon1 - lon2), the
+            // sines and cosines are computed once per location.
+            std::vector<double> latitude_sines(number_of_locations);
+            std::vector<double> latitude_cosines(number_of_locations);
+            std::vector<double> longitude_sines(number_of_locations);
+            std::vector<double> longitude_cosines(number_of_locations);
+            for (LocationId location_id = 0;
+                    location_id < number_of_locations;
+                    ++location_id) {
+                latitude_sines[location_id] = std::sin(latitudes[location_id]);
+                latitude_cosines[location_id] = std::cos(latitudes[location_id]);
+                longitude_sines[location_id] = std::sin(longitudes[location_id]);
+                longitude_cosines[location_id] = std::cos(longitudes[location_id]);
             }
+            compute_travel_times(
+                    [&latitude_sines, &latitude_cosines,
+                    &longitude_sines, &longitude_cosines,
+                    &geo_distance, rrr](LocationId location_id_1, LocationId location_id_2)
+                    {
+                        double q1
+                            = longitude_cosines[location_id_1] * longitude_cosines[location_id_2]
+                            + longitude_sines[location_id_1] * longitude_sines[location_id_2];
+                        double cos_angle
+                            = latitude_sines[location_id_1] * latitude_sines[location_id_2]
+                            + latitude_cosines[location_id_1] * latitude_cosines[location_id_2] * q1;
+                        double distance = rrr * acos(std::min(cos_angle, 1.0)) + 1.0;
+                        // Both formulas differ by rounding errors, which may
+                        // only change the truncated distance if it is close
+                        // to an integer. In this case, the original formula
+                        // is used to keep the same travel times.
+                        double fractional_part = distance - std::floor(distance);
+                        if (fractional_part < 1e-3 || fractional_part > 1 - 1e-3)
+                            distance = geo_distance(location_id_1, location_id_2);
+                        return (Time)distance;
+                    });
         } else if (edge_weight_type == "ATT") {
-            for (LocationId location_id_1 = 0;
-                    location_id_1 < number_of_locations;
-                    ++location_id_1) {
-                for (LocationId location_id_2 = location_id_1 + 1;
-                        location_id_2 < number_of_locations;
-                        ++location_id_2) {
-                    double xd = instance_.x(location_id_2) - instance_.x(location_id_1);
-                    double yd = instance_.y(location_id_2) - instance_.y(location_id_1);
-                    double rij = sqrt((xd * xd + yd * yd) / 10.0);
-                    int tij = std::round(rij);
-                    Time d = (tij < rij)? tij + 1: tij;
-                    set_travel_time(location_id_1, location_id_2, d);
-                }
-            }
+            compute_travel_times(
+                    [&xs, &ys](LocationId location_id_1, LocationId location_id_2)
+                    {
+                        double xd = xs[location_id_2] - xs[location_id_1];
+                        double yd = ys[location_id_2] - ys[location_id_1];
+                        double rij = sqrt((xd * xd + yd * yd) / 10.0);
+                        int tij = std::round(rij);
+                        return (Time)((tij < rij)? tij + 1: tij);
+                    });
         } else if (edge_weight_type == "EXPLICIT") {
         } else {
             throw std::invalid_argument(
@@ -704,5 +794,339 @@ private:
 
 };
 
+/**
+ * Split algorithm for a 'traveling_salesman_with_release_dates' problem.
+ *
+ * Given a giant tour visiting all locations except the depot, it computes an
+ * optimal partition of the giant tour into consecutive trips, that is, a
+ * partition minimizing the makespan.
+ *
+ * The trip serving the locations at positions i..j-1 of the giant tour
+ * starting after the trip ending at time f[i] ends at time
+ *     max(f[i], R(i, j)) + d(0, tᵢ) - D[i + 1] + D[j] + d(tⱼ₋₁, 0)
+ * where D is the prefix length of the giant tour and R(i, j) the maximum
+ * release date of the locations at positions i..j-1.
+ *
+ * For a fixed i, R(i, j) is non-decreasing with j. Therefore, each
+ * predecessor i is first "time-bound" (f[i] ≥ R(i, j)), and then, once a
+ * release date greater than f[i] has been met, "release-bound"
+ * (f[i] < R(i, j)) until the end:
+ * - the time-bound predecessors are stored in two heaps, one by f[i] to
+ *   detect when they become release-bound, and one by f[i] - D[i + 1] +
+ *   d(0, tᵢ) to retrieve the best one
+ * - the release-bound predecessors are stored in a segment tree over the
+ *   positions. The values R(i, j) are maintained with a monotone stack of
+ *   release dates; when a new release date is met, the positions whose
+ *   suffix maximum changes form an interval on which the new release date is
+ *   assigned lazily.
+ *
+ * The split runs in O(n log n) and doesn't require the travel times to
+ * satisfy the triangle inequality.
+ */
+class SplitEvaluator
+{
+
+public:
+
+    /** Structure for a trip of the output of the split. */
+    struct Trip
+    {
+        /** Position of the first location of the trip in the giant tour. */
+        LocationPos pos_first;
+
+        /** Position of the last location of the trip in the giant tour. */
+        LocationPos pos_last;
+
+        /** Start time of the trip. */
+        Time start;
+    };
+
+    /** Structure for the output of the split. */
+    struct Output
+    {
+        /** Makespan. */
+        Time makespan = 0;
+
+        /** Trips. */
+        std::vector<Trip> trips;
+    };
+
+    /** Constructor. */
+    SplitEvaluator(const Instance& instance):
+        instance_(instance)
+    { }
+
+    /**
+     * Split a giant tour.
+     *
+     * The giant tour contains each location except the depot once.
+     */
+    Output split(const std::vector<LocationId>& giant_tour)
+    {
+        LocationPos n = giant_tour.size();
+        Output output;
+        if (n == 0)
+            return output;
+
+        // Compute the parts of the trip durations which depend only on their
+        // first and on their last positions.
+        head_durations_.resize(n);
+        tail_durations_.resize(n + 1);
+        Time length = 0;
+        for (LocationPos pos = 0; pos < n; ++pos) {
+            if (pos > 0)
+                length += instance_.travel_time(giant_tour[pos - 1], giant_tour[pos]);
+            head_durations_[pos] = instance_.travel_time(0, giant_tour[pos]) - length;
+            tail_durations_[pos + 1] = length + instance_.travel_time(giant_tour[pos], 0);
+        }
+
+        // Initialize the data structures.
+        values_.resize(n + 1);
+        predecessors_.resize(n + 1);
+        release_dates_stack_.clear();
+        time_bound_by_value_.clear();
+        time_bound_by_end_.clear();
+        is_time_bound_.assign(n, false);
+        tree_size_ = 1;
+        while (tree_size_ < n)
+            tree_size_ *= 2;
+        tree_.assign(2 * tree_size_, Node());
+
+        values_[0] = 0;
+        for (LocationPos pos = 1; pos <= n; ++pos) {
+            LocationPos pos_prev = pos - 1;
+            Time release_date = instance_.release_date(giant_tour[pos_prev]);
+
+            // Add position 'pos_prev' as a time-bound predecessor.
+            is_time_bound_[pos_prev] = true;
+            push_heap(time_bound_by_value_, {values_[pos_prev] + head_durations_[pos_prev], pos_prev});
+            push_heap(time_bound_by_end_, {values_[pos_prev], pos_prev});
+
+            // Update the suffix maximums of the release dates.
+            LocationPos pos_start = pos_prev;
+            while (!release_dates_stack_.empty()
+                    && release_dates_stack_.back().first <= release_date) {
+                pos_start = release_dates_stack_.back().second;
+                release_dates_stack_.pop_back();
+            }
+            release_dates_stack_.push_back({release_date, pos_start});
+            assign(1, 0, tree_size_ - 1, pos_start, pos_prev, release_date);
+
+            // Positions whose trip end is smaller than the new release date
+            // become release-bound.
+            while (!time_bound_by_end_.empty()
+                    && time_bound_by_end_.front().first < release_date) {
+                LocationPos pos_2 = time_bound_by_end_.front().second;
+                pop_heap(time_bound_by_end_);
+                is_time_bound_[pos_2] = false;
+                activate(1, 0, tree_size_ - 1, pos_2, head_durations_[pos_2]);
+            }
+
+            // Retrieve the best predecessor.
+            while (!time_bound_by_value_.empty()
+                    && !is_time_bound_[time_bound_by_value_.front().second]) {
+                pop_heap(time_bound_by_value_);
+            }
+            Time value = std::numeric_limits<Time>::max();
+            if (!time_bound_by_value_.empty()) {
+                value = time_bound_by_value_.front().first;
+                predecessors_[pos] = time_bound_by_value_.front().second;
+            }
+            if (value > tree_[1].value) {
+                value = tree_[1].value;
+                predecessors_[pos] = tree_[1].pos;
+            }
+            values_[pos] = value + tail_durations_[pos];
+        }
+
+        // Retrieve the trips.
+        output.makespan = values_[n];
+        for (LocationPos pos = n; pos > 0; pos = predecessors_[pos]) {
+            LocationPos pos_first = predecessors_[pos];
+            output.trips.push_back({
+                    pos_first,
+                    pos - 1,
+                    values_[pos] - tail_durations_[pos] - head_durations_[pos_first]});
+        }
+        std::reverse(output.trips.begin(), output.trips.end());
+        return output;
+    }
+
+private:
+
+    /** Structure for a node of the segment tree of release-bound positions. */
+    struct Node
+    {
+        /** Minimum head duration of the release-bound positions of the node. */
+        Time head_duration = std::numeric_limits<Time>::max();
+
+        /** Position reaching 'head_duration'. */
+        LocationPos head_duration_pos = -1;
+
+        /** Minimum of R(i, j) + head duration over the positions of the node. */
+        Time value = std::numeric_limits<Time>::max();
+
+        /** Position reaching 'value'. */
+        LocationPos pos = -1;
+
+        /** Release date lazily assigned to the positions of the node. */
+        Time release_date = std::numeric_limits<Time>::min();
+    };
+
+    /*
+     * Private methods
+     */
+
+    /** Push an element into a min-heap. */
+    static void push_heap(
+            std::vector<std::pair<Time, LocationPos>>& heap,
+            const std::pair<Time, LocationPos>& element)
+    {
+        heap.push_back(element);
+        std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<Time, LocationPos>>());
+    }
+
+    /** Remove the smallest element of a min-heap. */
+    static void pop_heap(std::vector<std::pair<Time, LocationPos>>& heap)
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<Time, LocationPos>>());
+        heap.pop_back();
+    }
+
+    /** Assign a release date to all the positions of a node. */
+    void assign(
+            LocationPos node_id,
+            Time release_date)
+    {
+        Node& node = tree_[node_id];
+        node.release_date = release_date;
+        if (node.head_duration_pos != -1) {
+            node.value = release_date + node.head_duration;
+            node.pos = node.head_duration_pos;
+        }
+    }
+
+    /** Push the lazy release date of a node to its children. */
+    void push(LocationPos node_id)
+    {
+        if (tree_[node_id].release_date == std::numeric_limits<Time>::min())
+            return;
+        assign(2 * node_id, tree_[node_id].release_date);
+        assign(2 * node_id + 1, tree_[node_id].release_date);
+        tree_[node_id].release_date = std::numeric_limits<Time>::min();
+    }
+
+    /** Update a node from its children. */
+    void pull(LocationPos node_id)
+    {
+        Node& node = tree_[node_id];
+        const Node& node_1 = tree_[2 * node_id];
+        const Node& node_2 = tree_[2 * node_id + 1];
+        const Node& node_head = (node_1.head_duration <= node_2.head_duration)? node_1: node_2;
+        node.head_duration = node_head.head_duration;
+        node.head_duration_pos = node_head.head_duration_pos;
+        const Node& node_value = (node_1.value <= node_2.value)? node_1: node_2;
+        node.value = node_value.value;
+        node.pos = node_value.pos;
+    }
+
+    /** Assign a release date to the positions of an interval. */
+    void assign(
+            LocationPos node_id,
+            LocationPos node_pos_first,
+            LocationPos node_pos_last,
+            LocationPos pos_first,
+            LocationPos pos_last,
+            Time release_date)
+    {
+        if (pos_last < node_pos_first || node_pos_last < pos_first)
+            return;
+        if (pos_first <= node_pos_first && node_pos_last <= pos_last) {
+            assign(node_id, release_date);
+            return;
+        }
+        push(node_id);
+        LocationPos node_pos_middle = (node_pos_first + node_pos_last) / 2;
+        assign(2 * node_id, node_pos_first, node_pos_middle, pos_first, pos_last, release_date);
+        assign(2 * node_id + 1, node_pos_middle + 1, node_pos_last, pos_first, pos_last, release_date);
+        pull(node_id);
+    }
+
+    /** Make a position release-bound. */
+    void activate(
+            LocationPos node_id,
+            LocationPos node_pos_first,
+            LocationPos node_pos_last,
+            LocationPos pos,
+            Time head_duration)
+    {
+        if (node_pos_first == node_pos_last) {
+            Node& node = tree_[node_id];
+            node.head_duration = head_duration;
+            node.head_duration_pos = pos;
+            node.value = node.release_date + head_duration;
+            node.pos = pos;
+            return;
+        }
+        push(node_id);
+        LocationPos node_pos_middle = (node_pos_first + node_pos_last) / 2;
+        if (pos <= node_pos_middle) {
+            activate(2 * node_id, node_pos_first, node_pos_middle, pos, head_duration);
+        } else {
+            activate(2 * node_id + 1, node_pos_middle + 1, node_pos_last, pos, head_duration);
+        }
+        pull(node_id);
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Part of the duration of a trip which depends on its first position. */
+    std::vector<Time> head_durations_;
+
+    /** Part of the duration of a trip which depends on its last position. */
+    std::vector<Time> tail_durations_;
+
+    /** Values of the dynamic program. */
+    std::vector<Time> values_;
+
+    /** Predecessors of the dynamic program. */
+    std::vector<LocationPos> predecessors_;
+
+    /**
+     * Monotone stack of the suffix maximums of the release dates.
+     *
+     * Each element contains a release date and the first position of the
+     * interval of positions whose suffix maximum is this release date.
+     */
+    std::vector<std::pair<Time, LocationPos>> release_dates_stack_;
+
+    /** 'true' iff a position is a time-bound predecessor. */
+    std::vector<bool> is_time_bound_;
+
+    /**
+     * Min-heap of the time-bound predecessors ordered by f[i] + head
+     * duration.
+     *
+     * It may contain positions which are not time-bound anymore; they are
+     * removed lazily.
+     */
+    std::vector<std::pair<Time, LocationPos>> time_bound_by_value_;
+
+    /** Min-heap of the time-bound predecessors ordered by f[i]. */
+    std::vector<std::pair<Time, LocationPos>> time_bound_by_end_;
+
+    /** Number of leaves of the segment tree. */
+    LocationPos tree_size_ = 1;
+
+    /** Segment tree of the release-bound positions. */
+    std::vector<Node> tree_;
+
+};
+
 }
 }
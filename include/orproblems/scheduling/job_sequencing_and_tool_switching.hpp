@@ -25,6 +25,8 @@
 #include <iomanip>
 #include <vector>
 #include <algorithm>
+#include <bitset>
+#include <cstdint>
 
 namespace orproblems
 {
@@ -365,5 +367,359 @@ private:
 
 };
 
+/**
+ * Evaluator of the number of tool switches of a sequence of jobs of a
+ * 'job_sequencing_and_tool_switching' problem.
+ *
+ * The tools required by each job are stored as packed bitsets. The number of
+ * switches is computed with the Greedy Pipe Construction Algorithm (GPCA) of
+ * Cherniavskii and Goldengorin, which is equivalent to the Keep Tool Needed
+ * Soonest policy:
+ * - each tool required at position j has to be inserted, except if it is
+ *   kept in the magazine since its previous use at position i
+ * - the positions are processed in increasing order; keeping a tool over
+ *   positions i+1..j-1 (a "pipe") is possible if none of these positions has
+ *   a full magazine
+ * For position j, the positions i < j are scanned backward while keeping the
+ * bitset of the tools of job j whose previous use has not been met yet. At
+ * each position, the tools whose previous use is found are obtained with an
+ * AND between bitsets, and their number with popcount. They are kept as long
+ * as there is room in the magazine over their pipe.
+ *
+ * The kept tools are added to the magazine loads through a difference array
+ * (add at i+1, subtract at j). Since the positions are processed in
+ * increasing order, the load at a position is obtained by summing the
+ * difference array backward during the scan itself, so processing a position
+ * takes O(k w) where k is the number of scanned positions and w the number of
+ * words of a bitset.
+ *
+ * The pipes created by each position are stored. A move only replays the
+ * positions whose scan may be affected by it: the modified positions, and the
+ * positions whose scan reaches a position whose load may have changed. The
+ * evaluation stops as soon as no later scan reaches such a position.
+ */
+class ToolSwitchesEvaluator
+{
+
+public:
+
+    /** Constructor. */
+    ToolSwitchesEvaluator(const Instance& instance):
+        instance_(instance),
+        number_of_words_((instance.number_of_tools() + 63) / 64),
+        job_tools_(instance.number_of_jobs() * number_of_words_, 0),
+        alive_(number_of_words_)
+    {
+        for (JobId job_id = 0; job_id < instance.number_of_jobs(); ++job_id)
+            for (ToolId tool_id: instance.tools(job_id))
+                job_tools_[job_id * number_of_words_ + tool_id / 64] |= (uint64_t)1 << (tool_id % 64);
+    }
+
+    /** Set the sequence. */
+    void set_sequence(const std::vector<JobId>& sequence)
+    {
+        JobPos n = sequence.size();
+        sequence_ = sequence;
+        load_differences_.assign(n, 0);
+        pipes_.clear();
+        pipes_offsets_.resize(n + 1);
+        pipes_offsets_[0] = 0;
+        scan_ends_.resize(n);
+        kept_tools_prefix_sums_.resize(n + 1);
+        kept_tools_prefix_sums_[0] = 0;
+        number_of_required_tools_ = 0;
+        for (JobPos pos = 0; pos < n; ++pos) {
+            number_of_required_tools_ += instance_.tools(sequence[pos]).size();
+            kept_tools_prefix_sums_[pos + 1] = kept_tools_prefix_sums_[pos]
+                + process(sequence_, pos, load_differences_, pipes_, scan_ends_[pos]);
+            pipes_offsets_[pos + 1] = pipes_.size();
+        }
+        scan_ends_suffix_min_.resize(n + 1);
+        scan_ends_suffix_min_[n] = n;
+        for (JobPos pos = n - 1; pos >= 0; --pos)
+            scan_ends_suffix_min_[pos] = std::min(scan_ends_suffix_min_[pos + 1], scan_ends_[pos]);
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of jobs of the sequence. */
+    inline JobPos number_of_jobs() const { return sequence_.size(); }
+
+    /** Get the job at a position of the sequence. */
+    inline JobId job_id(JobPos pos) const { return sequence_[pos]; }
+
+    /** Get the bitset of the tools of a job. */
+    inline const uint64_t* tools(JobId job_id) const { return job_tools_.data() + job_id * number_of_words_; }
+
+    /** Get the number of tool switches of the sequence. */
+    inline ToolId number_of_switches() const { return number_of_required_tools_ - kept_tools_prefix_sums_[number_of_jobs()]; }
+
+    /*
+     * Moves
+     *
+     * Each method returns the difference between the number of switches of
+     * the sequence after the move and the current one.
+     */
+
+    /** Evaluate swapping the jobs at positions pos_1 and pos_2, with pos_1 < pos_2. */
+    ToolId swap(
+            JobPos pos_1,
+            JobPos pos_2)
+    {
+        sequence_tmp_ = sequence_;
+        std::swap(sequence_tmp_[pos_1], sequence_tmp_[pos_2]);
+        return evaluate(pos_1, pos_2);
+    }
+
+    /**
+     * Evaluate moving the job at position pos so that it ends up at position
+     * pos_new.
+     */
+    ToolId insertion(
+            JobPos pos,
+            JobPos pos_new)
+    {
+        if (pos == pos_new)
+            return 0;
+        sequence_tmp_ = sequence_;
+        if (pos < pos_new) {
+            std::rotate(
+                    sequence_tmp_.begin() + pos,
+                    sequence_tmp_.begin() + pos + 1,
+                    sequence_tmp_.begin() + pos_new + 1);
+        } else {
+            std::rotate(
+                    sequence_tmp_.begin() + pos_new,
+                    sequence_tmp_.begin() + pos,
+                    sequence_tmp_.begin() + pos + 1);
+        }
+        return evaluate(std::min(pos, pos_new), std::max(pos, pos_new));
+    }
+
+private:
+
+    /** Structure for a pipe, i.e. tools kept since their previous use. */
+    struct Pipe
+    {
+        /** Position of the previous use of the tools. */
+        JobPos pos_prev;
+
+        /** Number of tools. */
+        ToolId number_of_tools;
+    };
+
+    /*
+     * Private methods
+     */
+
+    /**
+     * Process a position of a sequence.
+     *
+     * 'load_differences' is the difference array of the tools kept in the
+     * magazine by the positions before pos: the number of tools in the
+     * magazine at a position is the number of tools of its job plus the
+     * prefix sum of 'load_differences' up to this position. It is updated
+     * with the tools kept by the job at position pos, whose pipes are
+     * appended to 'pipes'. 'scan_end' is set to the first position scanned.
+     *
+     * Return the number of tools of the job at position pos which are kept
+     * since their previous use.
+     */
+    ToolId process(
+            const std::vector<JobId>& sequence,
+            JobPos pos,
+            std::vector<ToolId>& load_differences,
+            std::vector<Pipe>& pipes,
+            JobPos& scan_end)
+    {
+        const uint64_t* tools_cur = tools(sequence[pos]);
+        std::copy(tools_cur, tools_cur + number_of_words_, alive_.begin());
+        ToolId number_of_kept_tools = 0;
+        // Minimum number of free slots of the magazine over positions
+        // pos_prev+1..pos-1.
+        ToolId free_slots = instance_.magazine_capacity();
+        // Number of kept tools in the magazine at position pos_prev. The
+        // pipes of the positions before pos end before pos, so the prefix
+        // sum of 'load_differences' up to pos - 1 is 0.
+        ToolId kept_load = 0;
+        scan_end = pos;
+        for (JobPos pos_prev = pos - 1; pos_prev >= 0; --pos_prev) {
+            scan_end = pos_prev;
+            if (pos_prev < pos - 1)
+                kept_load -= load_differences[pos_prev + 1];
+            const uint64_t* tools_prev = tools(sequence[pos_prev]);
+            ToolId number_of_found_tools = 0;
+            bool empty = true;
+            for (ToolId word = 0; word < number_of_words_; ++word) {
+                number_of_found_tools += popcount(alive_[word] & tools_prev[word]);
+                alive_[word] &= ~tools_prev[word];
+                if (alive_[word] != 0)
+                    empty = false;
+            }
+
+            // Keep as many of the found tools as possible.
+            ToolId number_of_new_kept_tools = std::min(number_of_found_tools, free_slots);
+            if (number_of_new_kept_tools > 0) {
+                load_differences[pos_prev + 1] += number_of_new_kept_tools;
+                load_differences[pos] -= number_of_new_kept_tools;
+                pipes.push_back({pos_prev, number_of_new_kept_tools});
+                number_of_kept_tools += number_of_new_kept_tools;
+                free_slots -= number_of_new_kept_tools;
+            }
+
+            if (empty)
+                break;
+            ToolId load = (ToolId)instance_.tools(sequence[pos_prev]).size() + kept_load;
+            free_slots = std::min(free_slots, instance_.magazine_capacity() - load);
+            if (free_slots <= 0)
+                break;
+        }
+        return number_of_kept_tools;
+    }
+
+    /** Add the pipes of a position of the current sequence to a difference array. */
+    void add_pipes(
+            JobPos pos,
+            std::vector<ToolId>& load_differences) const
+    {
+        for (JobPos pipe_pos = pipes_offsets_[pos];
+                pipe_pos < pipes_offsets_[pos + 1];
+                ++pipe_pos) {
+            load_differences[pipes_[pipe_pos].pos_prev + 1] += pipes_[pipe_pos].number_of_tools;
+            load_differences[pos] -= pipes_[pipe_pos].number_of_tools;
+        }
+    }
+
+    /**
+     * Compute the difference of number of switches between 'sequence_tmp_'
+     * and the current sequence, knowing that they are identical outside of
+     * positions pos_first..pos_last.
+     */
+    ToolId evaluate(
+            JobPos pos_first,
+            JobPos pos_last)
+    {
+        JobPos n = number_of_jobs();
+
+        // Build the difference array of the pipes of the positions before
+        // pos_first, either from these pipes or by removing the other ones
+        // from the complete difference array.
+        load_differences_tmp_.assign(n, 0);
+        if (2 * pipes_offsets_[pos_first] <= (JobPos)pipes_.size()) {
+            for (JobPos pos = 0; pos < pos_first; ++pos)
+                add_pipes(pos, load_differences_tmp_);
+        } else {
+            std::copy(
+                    load_differences_.begin(),
+                    load_differences_.begin() + pos_first,
+                    load_differences_tmp_.begin());
+            for (JobPos pipe_pos = pipes_offsets_[pos_first];
+                    pipe_pos < (JobPos)pipes_.size();
+                    ++pipe_pos) {
+                if (pipes_[pipe_pos].pos_prev + 1 < pos_first)
+                    load_differences_tmp_[pipes_[pipe_pos].pos_prev + 1] -= pipes_[pipe_pos].number_of_tools;
+            }
+        }
+
+        // The loads of the positions after 'pos_dirty' are the same in both
+        // sequences. A position of the same job whose scan doesn't reach
+        // 'pos_dirty' is processed identically in both sequences.
+        JobPos pos_dirty = -1;
+        ToolId difference = 0;
+        for (JobPos pos = pos_first; pos < n; ++pos) {
+            if (pos > pos_last && scan_ends_suffix_min_[pos] > pos_dirty)
+                break;
+            bool modified = (sequence_tmp_[pos] != sequence_[pos]);
+            if (!modified && scan_ends_[pos] > pos_dirty) {
+                add_pipes(pos, load_differences_tmp_);
+                continue;
+            }
+
+            pipes_tmp_.clear();
+            JobPos scan_end = -1;
+            ToolId number_of_kept_tools = process(
+                    sequence_tmp_,
+                    pos,
+                    load_differences_tmp_,
+                    pipes_tmp_,
+                    scan_end);
+            difference += kept_tools_prefix_sums_[pos + 1] - kept_tools_prefix_sums_[pos]
+                - number_of_kept_tools;
+
+            // If the job or its pipes changed, the loads of the positions
+            // before pos may have changed.
+            if (modified
+                    || !std::equal(
+                        pipes_tmp_.begin(),
+                        pipes_tmp_.end(),
+                        pipes_.begin() + pipes_offsets_[pos],
+                        pipes_.begin() + pipes_offsets_[pos + 1],
+                        [](const Pipe& pipe_1, const Pipe& pipe_2)
+                        {
+                            return pipe_1.pos_prev == pipe_2.pos_prev
+                                && pipe_1.number_of_tools == pipe_2.number_of_tools;
+                        })) {
+                pos_dirty = (modified)? pos: pos - 1;
+            }
+        }
+        return difference;
+    }
+
+    /** Get the number of bits set in a word. */
+    static inline ToolId popcount(uint64_t word) { return std::bitset<64>(word).count(); }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Number of 64-bit words of a tool bitset. */
+    ToolId number_of_words_;
+
+    /** Bitsets of the tools of each job. */
+    std::vector<uint64_t> job_tools_;
+
+    /** Sequence. */
+    std::vector<JobId> sequence_;
+
+    /** Total number of tools required by the jobs of the sequence. */
+    ToolId number_of_required_tools_ = 0;
+
+    /** Difference array of the tools kept in the magazine. */
+    std::vector<ToolId> load_differences_;
+
+    /** Pipes created by each position. */
+    std::vector<Pipe> pipes_;
+
+    /** Offsets of the pipes of each position in 'pipes_'. */
+    std::vector<JobPos> pipes_offsets_;
+
+    /** First position scanned when processing each position. */
+    std::vector<JobPos> scan_ends_;
+
+    /** 'scan_ends_suffix_min_[pos]' is the minimum of 'scan_ends_' from pos. */
+    std::vector<JobPos> scan_ends_suffix_min_;
+
+    /** Prefix sums of the number of kept tools. */
+    std::vector<ToolId> kept_tools_prefix_sums_;
+
+    /** Bitset of the tools whose previous use hasn't been found yet. */
+    std::vector<uint64_t> alive_;
+
+    /** Sequence after a move. */
+    std::vector<JobId> sequence_tmp_;
+
+    /** Difference array of the tools kept in the magazine after a move. */
+    std::vector<ToolId> load_differences_tmp_;
+
+    /** Pipes of the position being processed after a move. */
+    std::vector<Pipe> pipes_tmp_;
+
+};
+
 }
 }
@@ -17,6 +17,7 @@
 
 #include "interval-tree/interval_tree.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -76,6 +77,23 @@ public:
         return operations_[job_id][operation_pos];
     }
 
+    /** Get the total processing time of a job. */
+    inline Time processing_time(JobId job_id) const { return processing_times_[job_id]; }
+
+    /**
+     * Get the minimum start offset of a job after another job.
+     *
+     * It is the smallest delay δ >= 0 such that if job_id_1 starts at time
+     * s, then job_id_2 can start at time s + δ without any machine conflict
+     * between the two jobs.
+     */
+    inline Time start_offset(
+            JobId job_id_1,
+            JobId job_id_2) const
+    {
+        return start_offsets_[job_id_1 * number_of_jobs() + job_id_2];
+    }
+
     /*
      * Outputs
      */
@@ -256,6 +274,12 @@ private:
     /** Number of machines. */
     OperationId number_of_operations_ = 0;
 
+    /** Total processing times of the jobs. */
+    std::vector<Time> processing_times_;
+
+    /** Minimum start offsets between each ordered pair of jobs. */
+    std::vector<Time> start_offsets_;
+
     friend class InstanceBuilder;
 };
 
@@ -319,6 +343,8 @@ public:
         for (JobId job_id = 0; job_id < instance_.number_of_jobs(); ++job_id)
             instance_.number_of_operations_ += instance_.number_of_operations(job_id);
 
+        compute_start_offsets();
+
         return std::move(instance_);
     }
 
@@ -328,6 +354,71 @@ private:
      * Private methods
      */
 
+    /**
+     * Compute the total processing times of the jobs and the minimum start
+     * offsets between each ordered pair of jobs.
+     */
+    void compute_start_offsets()
+    {
+        JobId number_of_jobs = instance_.number_of_jobs();
+
+        // For each job and each machine, the start and end of the operations
+        // processed on the machine relatively to the start of the job.
+        std::vector<std::vector<std::vector<std::pair<Time, Time>>>> machine_operations(
+                number_of_jobs,
+                std::vector<std::vector<std::pair<Time, Time>>>(instance_.number_of_machines()));
+        instance_.processing_times_.resize(number_of_jobs);
+        for (JobId job_id = 0; job_id < number_of_jobs; ++job_id) {
+            Time current_time = 0;
+            for (OperationId operation_id = 0;
+                    operation_id < instance_.number_of_operations(job_id);
+                    ++operation_id) {
+                const Operation& operation = instance_.operation(job_id, operation_id);
+                machine_operations[job_id][operation.machine_id].push_back({
+                        current_time,
+                        current_time + operation.processing_time});
+                current_time += operation.processing_time;
+            }
+            instance_.processing_times_[job_id] = current_time;
+        }
+
+        instance_.start_offsets_.assign(number_of_jobs * number_of_jobs, 0);
+        std::vector<std::pair<Time, Time>> forbidden_offsets;
+        for (JobId job_id_1 = 0; job_id_1 < number_of_jobs; ++job_id_1) {
+            for (JobId job_id_2 = 0; job_id_2 < number_of_jobs; ++job_id_2) {
+                if (job_id_2 == job_id_1)
+                    continue;
+
+                // An operation processed during [a₁, b₁) relatively to the
+                // start of job_id_1 and an operation processed on the same
+                // machine during [a₂, b₂) relatively to the start of job_id_2
+                // overlap iff the offset belongs to the open interval
+                // (a₁ - b₂, b₁ - a₂).
+                forbidden_offsets.clear();
+                for (MachineId machine_id = 0;
+                        machine_id < instance_.number_of_machines();
+                        ++machine_id) {
+                    for (const auto& operation_1: machine_operations[job_id_1][machine_id]) {
+                        for (const auto& operation_2: machine_operations[job_id_2][machine_id]) {
+                            forbidden_offsets.push_back({
+                                    operation_1.first - operation_2.second,
+                                    operation_1.second - operation_2.first});
+                        }
+                    }
+                }
+                std::sort(forbidden_offsets.begin(), forbidden_offsets.end());
+
+                Time start_offset = 0;
+                for (const auto& interval: forbidden_offsets) {
+                    if (interval.first >= start_offset)
+                        break;
+                    start_offset = std::max(start_offset, interval.second);
+                }
+                instance_.start_offsets_[job_id_1 * number_of_jobs + job_id_2] = start_offset;
+            }
+        }
+    }
+
     void read_tamy0612(std::ifstream& file)
     {
         std::string tmp;
@@ -371,5 +462,110 @@ private:
 
 };
 
+/**
+ * Timetabling algorithm for a 'no_wait_job_shop_scheduling_makespan'
+ * problem.
+ *
+ * Given a permutation of the jobs, it schedules the jobs one by one in the
+ * order of the permutation. Each job starts at the earliest time, not before
+ * the start of the previous job, at which it has no machine conflict with the
+ * jobs already scheduled.
+ *
+ * The candidate start time of a job is first obtained from the start offset
+ * matrix of the instance with respect to the previous job of the
+ * permutation. Conflicts with the other scheduled jobs are then detected
+ * with one interval tree per machine; in case of conflict, the job is delayed
+ * until the end of the conflicting interval and the check starts again.
+ */
+class Timetabler
+{
+
+public:
+
+    /** Structure for the output of the timetabling. */
+    struct Output
+    {
+        /** Start times of the jobs. */
+        std::vector<Time> start_times;
+
+        /** Makespan. */
+        Time makespan = 0;
+    };
+
+    /** Constructor. */
+    Timetabler(const Instance& instance):
+        instance_(instance),
+        intervals_(instance.number_of_machines())
+    { }
+
+    /** Compute the start times of the jobs from a permutation. */
+    Output timetable(const std::vector<JobId>& permutation)
+    {
+        for (auto& intervals: intervals_)
+            intervals.clear();
+
+        Output output;
+        output.start_times.resize(instance_.number_of_jobs(), -1);
+        JobId job_id_prev = -1;
+        for (JobId job_id: permutation) {
+            Time start_time = (job_id_prev == -1)? 0:
+                output.start_times[job_id_prev]
+                + instance_.start_offset(job_id_prev, job_id);
+
+            // Delay the job until it doesn't conflict with the other
+            // scheduled jobs.
+            for (;;) {
+                bool conflict = false;
+                Time current_time = start_time;
+                for (OperationId operation_id = 0;
+                        operation_id < instance_.number_of_operations(job_id);
+                        ++operation_id) {
+                    const Operation& operation = instance_.operation(job_id, operation_id);
+                    Time completion_time = current_time + operation.processing_time;
+                    auto it = intervals_[operation.machine_id].overlap_find(
+                            {current_time, completion_time},
+                            true);
+                    if (it != intervals_[operation.machine_id].end()) {
+                        start_time += it->high() - current_time;
+                        conflict = true;
+                        break;
+                    }
+                    current_time = completion_time;
+                }
+                if (!conflict)
+                    break;
+            }
+
+            // Schedule the job.
+            Time current_time = start_time;
+            for (OperationId operation_id = 0;
+                    operation_id < instance_.number_of_operations(job_id);
+                    ++operation_id) {
+                const Operation& operation = instance_.operation(job_id, operation_id);
+                Time completion_time = current_time + operation.processing_time;
+                intervals_[operation.machine_id].insert_overlap({current_time, completion_time});
+                current_time = completion_time;
+            }
+            output.start_times[job_id] = start_time;
+            output.makespan = std::max(output.makespan, current_time);
+            job_id_prev = job_id;
+        }
+        return output;
+    }
+
+private:
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** For each machine, the intervals during which it is busy. */
+    std::vector<lib_interval_tree::interval_tree_t<Time>> intervals_;
+
+};
+
 }
 }
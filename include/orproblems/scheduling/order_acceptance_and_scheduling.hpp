@@ -28,9 +28,11 @@
 #include "optimizationtools/utils/utils.hpp"
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 namespace orproblems
 {
@@ -445,5 +447,299 @@ private:
 
 };
 
+/**
+ * Evaluator of the acceptance and rejection of jobs for an
+ * 'order_acceptance_and_scheduling' problem.
+ *
+ * Given the sequence of accepted jobs, it evaluates inserting an unscheduled
+ * job (acceptance) or removing a scheduled job (rejection).
+ *
+ * After such a move, the completion times of the following jobs are shifted.
+ * A positive shift is reduced by the idle time before each following job
+ * (time between the completion of its predecessor and its release date), and
+ * a negative shift is reduced by the time between the completion of the
+ * predecessor of each following job and its release date. As soon as the
+ * shift vanishes, the rest of the sequence is unchanged and its contribution
+ * is retrieved from suffix sums. Therefore, a move is evaluated in time
+ * proportional to the number of jobs it actually shifts.
+ *
+ * For each position, the evaluator also stores the maximum delay of the
+ * completion of the job which keeps it and all the following jobs within
+ * their deadlines. It allows checking the deadline feasibility of an
+ * insertion in O(1).
+ */
+class AcceptanceEvaluator
+{
+
+public:
+
+    /** Structure for the evaluation of a move. */
+    struct MoveEvaluation
+    {
+        /** Difference of objective value (profit minus weighted tardiness). */
+        Profit objective_difference;
+
+        /** 'true' iff no job of the resulting sequence ends after its deadline. */
+        bool feasible;
+    };
+
+    /** Constructor. */
+    AcceptanceEvaluator(const Instance& instance):
+        instance_(instance)
+    { }
+
+    /**
+     * Set the sequence of accepted jobs.
+     *
+     * It doesn't contain the first and last dummy jobs.
+     */
+    void set_sequence(const std::vector<JobId>& sequence)
+    {
+        JobPos n = sequence.size();
+        sequence_ = sequence;
+        completion_times_.resize(n);
+        Time current_time = 0;
+        JobId job_id_prev = 0;
+        for (JobPos pos = 0; pos < n; ++pos) {
+            JobId job_id = sequence[pos];
+            const Job& job = instance_.job(job_id);
+            current_time = std::max(current_time, job.release_date)
+                + instance_.setup_time(job_id_prev, job_id)
+                + job.processing_time;
+            completion_times_[pos] = current_time;
+            job_id_prev = job_id;
+        }
+
+        // Compute suffix values, suffix numbers of deadline violations and
+        // maximum delays.
+        value_suffix_sums_.resize(n + 1);
+        deadline_violations_suffix_sums_.resize(n + 1);
+        maximum_delays_.resize(n + 1);
+        value_suffix_sums_[n] = 0;
+        deadline_violations_suffix_sums_[n] = 0;
+        maximum_delays_[n] = std::numeric_limits<Time>::max();
+        for (JobPos pos = n - 1; pos >= 0; --pos) {
+            const Job& job = instance_.job(sequence[pos]);
+            value_suffix_sums_[pos] = value_suffix_sums_[pos + 1]
+                + value(sequence[pos], completion_times_[pos]);
+            deadline_violations_suffix_sums_[pos] = deadline_violations_suffix_sums_[pos + 1]
+                + ((completion_times_[pos] > job.deadline)? 1: 0);
+            if (deadline_violations_suffix_sums_[pos] > 0) {
+                maximum_delays_[pos] = 0;
+            } else {
+                // A delay of the completion of the job is reduced by the idle
+                // time before the next job.
+                Time maximum_delay = job.deadline - completion_times_[pos];
+                if (pos + 1 < n) {
+                    maximum_delay = std::min(
+                            maximum_delay,
+                            idle_time(pos + 1) + maximum_delays_[pos + 1]);
+                }
+                maximum_delays_[pos] = maximum_delay;
+            }
+        }
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of scheduled jobs. */
+    inline JobPos number_of_scheduled_jobs() const { return sequence_.size(); }
+
+    /** Get the job at a position of the sequence. */
+    inline JobId job_id(JobPos pos) const { return sequence_[pos]; }
+
+    /** Get the completion time of the job at a position of the sequence. */
+    inline Time completion_time(JobPos pos) const { return completion_times_[pos]; }
+
+    /**
+     * Get the start time of the job at a position of the sequence (before its
+     * setup time).
+     */
+    inline Time start_time(JobPos pos) const
+    {
+        Time completion_time_prev = (pos == 0)? 0: completion_times_[pos - 1];
+        return std::max(completion_time_prev, instance_.job(sequence_[pos]).release_date);
+    }
+
+    /**
+     * Get the idle time before the job at a position of the sequence, that is,
+     * the slack between the completion of its predecessor and its release
+     * date.
+     */
+    inline Time idle_time(JobPos pos) const
+    {
+        Time completion_time_prev = (pos == 0)? 0: completion_times_[pos - 1];
+        return std::max((Time)0, instance_.job(sequence_[pos]).release_date - completion_time_prev);
+    }
+
+    /**
+     * Get the maximum delay of the completion of the job at a position of the
+     * sequence such that this job and all the following ones end before their
+     * deadlines.
+     *
+     * It is '0' if one of these jobs already ends after its deadline.
+     */
+    inline Time maximum_delay(JobPos pos) const { return maximum_delays_[pos]; }
+
+    /** Get the objective value of the sequence. */
+    inline Profit objective() const { return value_suffix_sums_[0]; }
+
+    /** Return 'true' iff no job of the sequence ends after its deadline. */
+    inline bool feasible() const { return deadline_violations_suffix_sums_[0] == 0; }
+
+    /*
+     * Moves
+     */
+
+    /**
+     * Evaluate the insertion of an unscheduled job right before the job at
+     * position pos.
+     *
+     * 'pos' can be 'number_of_scheduled_jobs()' to insert the job at the end
+     * of the sequence.
+     */
+    inline MoveEvaluation insertion(
+            JobId job_id,
+            JobPos pos) const
+    {
+        const Job& job = instance_.job(job_id);
+        Time completion_time_prev = (pos == 0)? 0: completion_times_[pos - 1];
+        JobId job_id_prev = (pos == 0)? 0: sequence_[pos - 1];
+        Time completion_time = std::max(completion_time_prev, job.release_date)
+            + instance_.setup_time(job_id_prev, job_id)
+            + job.processing_time;
+        MoveEvaluation move_evaluation = evaluate_suffix(
+                pos,
+                job_id,
+                completion_time,
+                deadline_violations_suffix_sums_[0]
+                - deadline_violations_suffix_sums_[pos]
+                + ((completion_time > job.deadline)? 1: 0));
+        move_evaluation.objective_difference += value(job_id, completion_time);
+        return move_evaluation;
+    }
+
+    /**
+     * Return 'true' iff inserting an unscheduled job right before the job at
+     * position pos keeps all jobs within their deadlines.
+     *
+     * This check runs in O(1).
+     */
+    inline bool insertion_feasible(
+            JobId job_id,
+            JobPos pos) const
+    {
+        if (deadline_violations_suffix_sums_[0] > 0)
+            return false;
+        const Job& job = instance_.job(job_id);
+        Time completion_time_prev = (pos == 0)? 0: completion_times_[pos - 1];
+        JobId job_id_prev = (pos == 0)? 0: sequence_[pos - 1];
+        Time completion_time = std::max(completion_time_prev, job.release_date)
+            + instance_.setup_time(job_id_prev, job_id)
+            + job.processing_time;
+        if (completion_time > job.deadline)
+            return false;
+        if (pos == number_of_scheduled_jobs())
+            return true;
+        const Job& job_next = instance_.job(sequence_[pos]);
+        Time completion_time_next = std::max(completion_time, job_next.release_date)
+            + instance_.setup_time(job_id, sequence_[pos])
+            + job_next.processing_time;
+        return completion_time_next - completion_times_[pos] <= maximum_delays_[pos];
+    }
+
+    /** Evaluate the removal of the job at position pos. */
+    inline MoveEvaluation removal(JobPos pos) const
+    {
+        Time completion_time_prev = (pos == 0)? 0: completion_times_[pos - 1];
+        JobId job_id_prev = (pos == 0)? 0: sequence_[pos - 1];
+        MoveEvaluation move_evaluation = evaluate_suffix(
+                pos + 1,
+                job_id_prev,
+                completion_time_prev,
+                deadline_violations_suffix_sums_[0]
+                - deadline_violations_suffix_sums_[pos]);
+        move_evaluation.objective_difference -= value(sequence_[pos], completion_times_[pos]);
+        return move_evaluation;
+    }
+
+private:
+
+    /*
+     * Private methods
+     */
+
+    /** Get the contribution of a job completed at a given time to the objective. */
+    inline Profit value(
+            JobId job_id,
+            Time completion_time) const
+    {
+        const Job& job = instance_.job(job_id);
+        if (completion_time > job.due_date)
+            return job.profit - job.weight * (completion_time - job.due_date);
+        return job.profit;
+    }
+
+    /**
+     * Evaluate the jobs at positions pos..n-1 if they are preceded by a job
+     * completed at a given time.
+     *
+     * 'number_of_deadline_violations' is the number of deadline violations
+     * of the jobs scheduled before them.
+     */
+    inline MoveEvaluation evaluate_suffix(
+            JobPos pos,
+            JobId job_id_prev,
+            Time current_time,
+            JobPos number_of_deadline_violations) const
+    {
+        JobPos n = number_of_scheduled_jobs();
+        Profit objective_difference = 0;
+        for (; pos < n; ++pos) {
+            JobId job_id = sequence_[pos];
+            const Job& job = instance_.job(job_id);
+            current_time = std::max(current_time, job.release_date)
+                + instance_.setup_time(job_id_prev, job_id)
+                + job.processing_time;
+            if (current_time == completion_times_[pos]) {
+                // The shift vanished, the rest of the sequence is unchanged.
+                number_of_deadline_violations += deadline_violations_suffix_sums_[pos];
+                break;
+            }
+            objective_difference += value(job_id, current_time)
+                - value(job_id, completion_times_[pos]);
+            if (current_time > job.deadline)
+                number_of_deadline_violations++;
+            job_id_prev = job_id;
+        }
+        return {objective_difference, number_of_deadline_violations == 0};
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Sequence of accepted jobs. */
+    std::vector<JobId> sequence_;
+
+    /** Completion times of the jobs of the sequence. */
+    std::vector<Time> completion_times_;
+
+    /** Suffix sums of the contributions of the jobs to the objective. */
+    std::vector<Profit> value_suffix_sums_;
+
+    /** Suffix sums of the number of jobs ending after their deadline. */
+    std::vector<JobPos> deadline_violations_suffix_sums_;
+
+    /** Maximum delays, see 'maximum_delay'. */
+    std::vector<Time> maximum_delays_;
+
+};
+
 }
 }
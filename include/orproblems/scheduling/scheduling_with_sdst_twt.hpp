@@ -20,9 +20,14 @@
 
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <new>
 
 namespace orproblems
 {
@@ -49,6 +54,50 @@ struct Job
     Weight weight = 1;
 };
 
+/**
+ * Allocator returning memory aligned on 64 bytes.
+ *
+ * It is used to store the setup times so that each of their padded rows
+ * starts on a cache line and can be read with aligned vector loads.
+ */
+template <typename T>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    /** Alignment in bytes. */
+    static constexpr std::size_t alignment = 64;
+
+    AlignedAllocator() { }
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) { }
+
+    T* allocate(std::size_t n)
+    {
+        // Over-allocate and store the original pointer right before the
+        // aligned block.
+        char* raw = static_cast<char*>(::operator new(
+                    n * sizeof(T) + alignment + sizeof(void*)));
+        std::uintptr_t aligned
+            = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*) + alignment - 1)
+            & ~(std::uintptr_t)(alignment - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
+
 /**
  * Instance class for a 'scheduling_with_sdst_twt' problem.
  */
@@ -70,14 +119,30 @@ public:
     /** Get the number of jobs with a null weight. */
     inline JobId number_of_zero_weight_jobs() const { return number_of_zero_weight_jobs_; }
 
-    /** Get the setup time between two jobs. */
+    /**
+     * Get the setup time between two jobs.
+     *
+     * 'job_id_1' can be 'number_of_jobs()' for the initial state.
+     */
     inline Time setup_time(
             JobId job_id_1,
             JobId job_id_2) const
     {
-        return setup_times_[job_id_1][job_id_2];
+        return setup_times_[job_id_1 * setup_times_stride_ + job_id_2];
     }
 
+    /**
+     * Get the setup times from a job to each job.
+     *
+     * 'job_id' can be 'number_of_jobs()' for the initial state. The returned
+     * row is aligned on 64 bytes and padded with zeros up to
+     * 'setup_times_stride()' elements.
+     */
+    inline const Time* setup_times(JobId job_id) const { return setup_times_.data() + job_id * setup_times_stride_; }
+
+    /** Get the number of elements between two consecutive setup times rows. */
+    inline JobId setup_times_stride() const { return setup_times_stride_; }
+
     /*
      * Outputs
      */
@@ -239,8 +304,16 @@ private:
     /** Jobs. */
     std::vector<Job> jobs_;
 
-    /** Setup times. */
-    std::vector<std::vector<Time>> setup_times_;
+    /**
+     * Setup times.
+     *
+     * They are stored row by row, with an extra row for the initial state.
+     * Each row is padded to a multiple of 64 bytes.
+     */
+    std::vector<Time, AlignedAllocator<Time>> setup_times_;
+
+    /** Number of elements of a setup times row, including the padding. */
+    JobId setup_times_stride_ = 0;
 
     /** Number of jobs with a null weight. */
     JobPos number_of_zero_weight_jobs_ = 0;
@@ -263,10 +336,15 @@ public:
      */
     void set_number_of_jobs(JobId number_of_jobs)
     {
-        instance_.jobs_ = std::vector<Job>(number_of_jobs),
-        instance_.setup_times_ = std::vector<std::vector<Time>>(
-                number_of_jobs + 1,
-                std::vector<Time>(number_of_jobs + 1, 0));
+        instance_.jobs_ = std::vector<Job>(number_of_jobs);
+        JobId number_of_elements_per_line = AlignedAllocator<Time>::alignment / sizeof(Time);
+        instance_.setup_times_stride_
+            = (number_of_jobs + number_of_elements_per_line - 1)
+            / number_of_elements_per_line
+            * number_of_elements_per_line;
+        instance_.setup_times_.assign(
+                (number_of_jobs + 1) * instance_.setup_times_stride_,
+                0);
     }
 
     /** Set the processing-time of a job. */
@@ -301,7 +379,7 @@ public:
     {
         if (job_id_1 == -1)
             job_id_1 = instance_.number_of_jobs();
-        instance_.setup_times_[job_id_1][job_id_2] = setup_time;
+        instance_.setup_times_[job_id_1 * instance_.setup_times_stride_ + job_id_2] = setup_time;
     }
 
     /** Build an instance from a file. */
@@ -417,5 +495,291 @@ private:
 
 };
 
+/**
+ * Evaluator of the neighborhoods of a sequence of a 'scheduling_with_sdst_twt'
+ * problem.
+ *
+ * The sequence obtained after an insertion, or-opt or swap move is a
+ * concatenation of at most 5 segments of consecutive positions of the current
+ * sequence. Inside a segment, setup times are unchanged, so all its jobs are
+ * shifted by the same delay Δ, which only depends on the job preceding the
+ * segment and on its completion time.
+ *
+ * For each position j of the current sequence with completion time Cⱼ, the
+ * evaluator stores:
+ * - the delay it can absorb without becoming tardy: dⱼ - Cⱼ if it is not tardy
+ * - the advance it can absorb while remaining tardy: Cⱼ - dⱼ if it is tardy
+ * together with prefix sums of the weighted tardiness and of the weights of
+ * the tardy jobs, and sparse tables to get the minimum absorbable delay and
+ * advance of any segment in O(1).
+ *
+ * If the shift Δ of a segment is absorbable by all its jobs, its weighted
+ * tardiness is T + W Δ, where T is its current weighted tardiness and W the
+ * weight of its tardy jobs, and the segment is evaluated in O(1). Otherwise,
+ * the segment is evaluated exactly by walking through it.
+ *
+ * Setting a sequence takes O(n log n).
+ */
+class SequenceEvaluator
+{
+
+public:
+
+    /** Constructor. */
+    SequenceEvaluator(const Instance& instance):
+        instance_(instance)
+    { }
+
+    /** Set the sequence. */
+    void set_sequence(const std::vector<JobId>& sequence)
+    {
+        JobPos n = sequence.size();
+        sequence_ = sequence;
+        completion_times_.resize(n);
+        weighted_tardiness_prefix_sums_.resize(n + 1);
+        tardy_weight_prefix_sums_.resize(n + 1);
+        weighted_tardiness_prefix_sums_[0] = 0;
+        tardy_weight_prefix_sums_[0] = 0;
+
+        // Compute the log table.
+        logs_.resize(n + 1);
+        logs_[0] = 0;
+        if (n >= 1)
+            logs_[1] = 0;
+        for (JobPos length = 2; length <= n; ++length)
+            logs_[length] = logs_[length / 2] + 1;
+        JobPos number_of_levels = (n == 0)? 1: logs_[n] + 1;
+        absorbable_delays_.resize(number_of_levels * n);
+        absorbable_advances_.resize(number_of_levels * n);
+
+        Time current_time = 0;
+        JobId job_id_prev = instance_.number_of_jobs();
+        for (JobPos pos = 0; pos < n; ++pos) {
+            JobId job_id = sequence[pos];
+            const Job& job = instance_.job(job_id);
+            current_time += instance_.setup_time(job_id_prev, job_id) + job.processing_time;
+            completion_times_[pos] = current_time;
+            weighted_tardiness_prefix_sums_[pos + 1] = weighted_tardiness_prefix_sums_[pos];
+            tardy_weight_prefix_sums_[pos + 1] = tardy_weight_prefix_sums_[pos];
+            absorbable_delays_[pos] = std::numeric_limits<Time>::max();
+            absorbable_advances_[pos] = std::numeric_limits<Time>::max();
+            if (job.weight != 0) {
+                if (current_time > job.due_date) {
+                    weighted_tardiness_prefix_sums_[pos + 1]
+                        += job.weight * (current_time - job.due_date);
+                    tardy_weight_prefix_sums_[pos + 1] += job.weight;
+                    absorbable_advances_[pos] = current_time - job.due_date;
+                } else {
+                    absorbable_delays_[pos] = job.due_date - current_time;
+                }
+            }
+            job_id_prev = job_id;
+        }
+
+        // Compute the sparse tables.
+        for (JobPos level = 1; level < number_of_levels; ++level) {
+            JobPos half = (JobPos)1 << (level - 1);
+            for (JobPos pos = 0; pos + 2 * half <= n; ++pos) {
+                absorbable_delays_[level * n + pos] = std::min(
+                        absorbable_delays_[(level - 1) * n + pos],
+                        absorbable_delays_[(level - 1) * n + pos + half]);
+                absorbable_advances_[level * n + pos] = std::min(
+                        absorbable_advances_[(level - 1) * n + pos],
+                        absorbable_advances_[(level - 1) * n + pos + half]);
+            }
+        }
+    }
+
+    /*
+     * Getters
+     */
+
+    /** Get the number of jobs of the sequence. */
+    inline JobPos number_of_jobs() const { return sequence_.size(); }
+
+    /** Get the job at a position of the sequence. */
+    inline JobId job_id(JobPos pos) const { return sequence_[pos]; }
+
+    /** Get the completion time of the job at a position of the sequence. */
+    inline Time completion_time(JobPos pos) const { return completion_times_[pos]; }
+
+    /** Get the total weighted tardiness of the sequence. */
+    inline Weight total_weighted_tardiness() const { return weighted_tardiness_prefix_sums_[number_of_jobs()]; }
+
+    /*
+     * Moves
+     *
+     * Each method returns the difference between the total weighted tardiness
+     * of the sequence after the move and the current one.
+     */
+
+    /**
+     * Evaluate moving the jobs at positions pos_first..pos_last right before
+     * the job at position pos, with pos < pos_first or pos > pos_last + 1.
+     *
+     * 'pos' can be 'number_of_jobs()' to move the jobs at the end of the
+     * sequence.
+     */
+    inline Weight or_opt(
+            JobPos pos_first,
+            JobPos pos_last,
+            JobPos pos) const
+    {
+        if (pos < pos_first) {
+            return evaluate({
+                    {0, pos - 1},
+                    {pos_first, pos_last},
+                    {pos, pos_first - 1},
+                    {pos_last + 1, number_of_jobs() - 1}});
+        } else {
+            return evaluate({
+                    {0, pos_first - 1},
+                    {pos_last + 1, pos - 1},
+                    {pos_first, pos_last},
+                    {pos, number_of_jobs() - 1}});
+        }
+    }
+
+    /**
+     * Evaluate moving the job at position pos so that it ends up at position
+     * pos_new.
+     */
+    inline Weight insertion(
+            JobPos pos,
+            JobPos pos_new) const
+    {
+        if (pos_new == pos) {
+            return 0;
+        } else if (pos_new < pos) {
+            return or_opt(pos, pos, pos_new);
+        } else {
+            return or_opt(pos, pos, pos_new + 1);
+        }
+    }
+
+    /**
+     * Evaluate swapping the jobs at positions pos_1 and pos_2, with
+     * pos_1 < pos_2.
+     */
+    inline Weight swap(
+            JobPos pos_1,
+            JobPos pos_2) const
+    {
+        return evaluate({
+                {0, pos_1 - 1},
+                {pos_2, pos_2},
+                {pos_1 + 1, pos_2 - 1},
+                {pos_1, pos_1},
+                {pos_2 + 1, number_of_jobs() - 1}});
+    }
+
+private:
+
+    /** Structure for a segment of consecutive positions of the sequence. */
+    struct Segment
+    {
+        /** First position; the segment is empty if it is after 'pos_last'. */
+        JobPos pos_first;
+
+        /** Last position. */
+        JobPos pos_last;
+    };
+
+    /*
+     * Private methods
+     */
+
+    /** Get the minimum of a sparse table over the positions pos_first..pos_last. */
+    inline Time range_minimum(
+            const std::vector<Time>& sparse_table,
+            JobPos pos_first,
+            JobPos pos_last) const
+    {
+        JobPos level = logs_[pos_last - pos_first + 1];
+        JobPos n = number_of_jobs();
+        return std::min(
+                sparse_table[level * n + pos_first],
+                sparse_table[level * n + pos_last + 1 - ((JobPos)1 << level)]);
+    }
+
+    /**
+     * Evaluate the sequence made of the concatenation of segments of the
+     * current sequence, and return the difference with the current total
+     * weighted tardiness.
+     */
+    inline Weight evaluate(std::initializer_list<Segment> segments) const
+    {
+        Time current_time = 0;
+        JobId job_id_prev = instance_.number_of_jobs();
+        Weight value = 0;
+        for (const Segment& segment: segments) {
+            if (segment.pos_first > segment.pos_last)
+                continue;
+
+            // Compute the shift of the segment.
+            JobId job_id_first = sequence_[segment.pos_first];
+            Time completion_time_first = current_time
+                + instance_.setup_time(job_id_prev, job_id_first)
+                + instance_.job(job_id_first).processing_time;
+            Time shift = completion_time_first - completion_times_[segment.pos_first];
+
+            if (shift == 0
+                    || (shift > 0 && shift <= range_minimum(
+                            absorbable_delays_, segment.pos_first, segment.pos_last))
+                    || (shift < 0 && -shift <= range_minimum(
+                            absorbable_advances_, segment.pos_first, segment.pos_last))) {
+                // The set of tardy jobs of the segment doesn't change.
+                value
+                    += weighted_tardiness_prefix_sums_[segment.pos_last + 1]
+                    - weighted_tardiness_prefix_sums_[segment.pos_first]
+                    + (tardy_weight_prefix_sums_[segment.pos_last + 1]
+                            - tardy_weight_prefix_sums_[segment.pos_first])
+                    * shift;
+            } else {
+                // Walk through the segment.
+                for (JobPos pos = segment.pos_first; pos <= segment.pos_last; ++pos) {
+                    const Job& job = instance_.job(sequence_[pos]);
+                    Time completion_time = completion_times_[pos] + shift;
+                    if (completion_time > job.due_date)
+                        value += job.weight * (completion_time - job.due_date);
+                }
+            }
+
+            current_time = completion_times_[segment.pos_last] + shift;
+            job_id_prev = sequence_[segment.pos_last];
+        }
+        return value - total_weighted_tardiness();
+    }
+
+    /*
+     * Private attributes
+     */
+
+    /** Instance. */
+    const Instance& instance_;
+
+    /** Sequence. */
+    std::vector<JobId> sequence_;
+
+    /** Completion times of the jobs of the sequence. */
+    std::vector<Time> completion_times_;
+
+    /** Prefix sums of the weighted tardiness. */
+    std::vector<Weight> weighted_tardiness_prefix_sums_;
+
+    /** Prefix sums of the weights of the tardy jobs. */
+    std::vector<Weight> tardy_weight_prefix_sums_;
+
+    /** 'logs_[l]' is the floor of the base 2 logarithm of l. */
+    std::vector<JobPos> logs_;
+
+    /** Sparse table of the delays absorbable by the jobs without becoming tardy. */
+    std::vector<Time> absorbable_delays_;
+
+    /** Sparse table of the advances absorbable by the tardy jobs while remaining tardy. */
+    std::vector<Time> absorbable_advances_;
+
+};
+
 }
 }
@@ -22,6 +22,7 @@
 #include "optimizationtools/utils/utils.hpp"
 #include "optimizationtools/containers/indexed_set.hpp"
 
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -71,6 +72,48 @@ public:
     /** Get the predecessors of location. */
     inline const std::vector<LocationId>& predecessors(LocationId location_id) const { return locations_[location_id].predecessors; }
 
+    /**
+     * Get the rank of a location in a topological order of the precedence
+     * graph.
+     *
+     * If location_id_1 must be visited before location_id_2, then
+     * 'topological_rank(location_id_1) < topological_rank(location_id_2)'.
+     */
+    inline LocationPos topological_rank(LocationId location_id) const { return topological_ranks_[location_id]; }
+
+    /** Get the number of 64-bit words of the precedence bitsets. */
+    inline LocationId number_of_bitset_words() const { return number_of_bitset_words_; }
+
+    /**
+     * Get the bitset of the locations which must be visited before a
+     * location, that is, of its predecessors in the transitive closure of the
+     * precedence graph.
+     */
+    inline const uint64_t* all_predecessors(LocationId location_id) const
+    {
+        return all_predecessors_.data() + location_id * number_of_bitset_words_;
+    }
+
+    /**
+     * Get the bitset of the locations which must be visited after a location,
+     * that is, of its successors in the transitive closure of the precedence
+     * graph.
+     */
+    inline const uint64_t* all_successors(LocationId location_id) const
+    {
+        return all_successors_.data() + location_id * number_of_bitset_words_;
+    }
+
+    /** Return 'true' iff location_id_1 must be visited before location_id_2. */
+    inline bool precedes(
+            LocationId location_id_1,
+            LocationId location_id_2) const
+    {
+        if (topological_ranks_[location_id_1] >= topological_ranks_[location_id_2])
+            return false;
+        return (all_predecessors(location_id_2)[location_id_1 / 64] >> (location_id_1 % 64)) & 1;
+    }
+
     /*
      * Outputs
      */
@@ -249,6 +292,18 @@ private:
      * Computed attributes
      */
 
+    /** Topological ranks of the locations. */
+    std::vector<LocationPos> topological_ranks_;
+
+    /** Number of 64-bit words of the precedence bitsets. */
+    LocationId number_of_bitset_words_ = 0;
+
+    /** Bitsets of the predecessors in the transitive closure. */
+    std::vector<uint64_t> all_predecessors_;
+
+    /** Bitsets of the successors in the transitive closure. */
+    std::vector<uint64_t> all_successors_;
+
     friend class InstanceBuilder;
 };
 
@@ -323,6 +378,7 @@ public:
     /** Build the instance. */
     Instance build()
     {
+        compute_precedence_closure();
         return std::move(instance_);
     }
 
@@ -332,6 +388,77 @@ private:
      * Private methods
      */
 
+    /**
+     * Compute the topological ranks of the locations and the transitive
+     * closure of the precedence graph.
+     */
+    void compute_precedence_closure()
+    {
+        LocationId number_of_locations = instance_.number_of_locations();
+
+        // Compute a topological order.
+        std::vector<std::vector<LocationId>> successors(number_of_locations);
+        std::vector<LocationId> number_of_predecessors(number_of_locations, 0);
+        for (LocationId location_id = 0;
+                location_id < number_of_locations;
+                ++location_id) {
+            for (LocationId location_id_pred: instance_.predecessors(location_id)) {
+                successors[location_id_pred].push_back(location_id);
+                number_of_predecessors[location_id]++;
+            }
+        }
+        std::vector<LocationId> topological_order;
+        for (LocationId location_id = 0;
+                location_id < number_of_locations;
+                ++location_id) {
+            if (number_of_predecessors[location_id] == 0)
+                topological_order.push_back(location_id);
+        }
+        for (LocationPos pos = 0; pos < (LocationPos)topological_order.size(); ++pos) {
+            for (LocationId location_id_next: successors[topological_order[pos]]) {
+                number_of_predecessors[location_id_next]--;
+                if (number_of_predecessors[location_id_next] == 0)
+                    topological_order.push_back(location_id_next);
+            }
+        }
+        if ((LocationPos)topological_order.size() != number_of_locations) {
+            throw std::invalid_argument(
+                    "The precedence graph contains a cycle.");
+        }
+        instance_.topological_ranks_.resize(number_of_locations);
+        for (LocationPos pos = 0; pos < number_of_locations; ++pos)
+            instance_.topological_ranks_[topological_order[pos]] = pos;
+
+        // Compute the transitive closure.
+        LocationId number_of_words = (number_of_locations + 63) / 64;
+        instance_.number_of_bitset_words_ = number_of_words;
+        instance_.all_predecessors_.assign(number_of_locations * number_of_words, 0);
+        instance_.all_successors_.assign(number_of_locations * number_of_words, 0);
+        for (LocationId location_id: topological_order) {
+            uint64_t* bitset = instance_.all_predecessors_.data()
+                + location_id * number_of_words;
+            for (LocationId location_id_pred: instance_.predecessors(location_id)) {
+                const uint64_t* bitset_pred = instance_.all_predecessors_.data()
+                    + location_id_pred * number_of_words;
+                for (LocationId word = 0; word < number_of_words; ++word)
+                    bitset[word] |= bitset_pred[word];
+                bitset[location_id_pred / 64] |= (uint64_t)1 << (location_id_pred % 64);
+            }
+        }
+        for (auto it = topological_order.rbegin(); it != topological_order.rend(); ++it) {
+            LocationId location_id = *it;
+            uint64_t* bitset = instance_.all_successors_.data()
+                + location_id * number_of_words;
+            for (LocationId location_id_next: successors[location_id]) {
+                const uint64_t* bitset_next = instance_.all_successors_.data()
+                    + location_id_next * number_of_words;
+                for (LocationId word = 0; word < number_of_words; ++word)
+                    bitset[word] |= bitset_next[word];
+                bitset[location_id_next / 64] |= (uint64_t)1 << (location_id_next % 64);
+            }
+        }
+    }
+
     /** Read a file in 'tsplib' format. */
     void read_tsplib(std::ifstream& file)
     {
@@ -0,0 +1,160 @@
+#include "orproblems/packing/multidimensional_multiple_choice_knapsack.hpp"
+
+#include <random>
+
+using namespace orproblems::multidimensional_multiple_choice_knapsack;
+
+/**
+ * Compute the optimal profit of an instance by enumerating all solutions
+ * compatible with the fixed items.
+ *
+ * Return '-inf' if there is no feasible solution.
+ */
+double brute_force(
+        const Instance& instance,
+        const std::vector<ItemId>& fixed_item_ids)
+{
+    double optimum = -std::numeric_limits<double>::infinity();
+    std::vector<ItemId> item_ids(instance.number_of_groups(), 0);
+    for (;;) {
+        bool compatible = true;
+        for (GroupId group_id = 0; group_id < instance.number_of_groups(); ++group_id) {
+            if (fixed_item_ids[group_id] != -1
+                    && fixed_item_ids[group_id] != item_ids[group_id]) {
+                compatible = false;
+            }
+        }
+        if (compatible) {
+            bool feasible = true;
+            for (ResourceId resource_id = 0;
+                    resource_id < instance.number_of_resources();
+                    ++resource_id) {
+                Weight weight = 0;
+                for (GroupId group_id = 0; group_id < instance.number_of_groups(); ++group_id)
+                    weight += instance.weight(group_id, item_ids[group_id], resource_id);
+                if (weight > instance.capacity(resource_id))
+                    feasible = false;
+            }
+            if (feasible) {
+                Profit profit = 0;
+                for (GroupId group_id = 0; group_id < instance.number_of_groups(); ++group_id)
+                    profit += instance.item(group_id, item_ids[group_id]).profit;
+                optimum = std::max(optimum, (double)profit);
+            }
+        }
+
+        // Next combination.
+        GroupId group_id = 0;
+        while (group_id < instance.number_of_groups()
+                && ++item_ids[group_id] == instance.number_of_items(group_id)) {
+            item_ids[group_id] = 0;
+            group_id++;
+        }
+        if (group_id == instance.number_of_groups())
+            break;
+    }
+    return optimum;
+}
+
+/** Check that the bound is not smaller than the optimum. */
+bool check_bound(
+        SurrogateRelaxationBound& bound,
+        const Instance& instance,
+        const std::vector<ItemId>& fixed_item_ids)
+{
+    double optimum = brute_force(instance, fixed_item_ids);
+    double value = bound.bound();
+    if (value < optimum) {
+        std::cerr << "Bound " << value << " < optimum " << optimum << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    bool ok = true;
+
+    // Lightest items summing exactly to the capacities.
+    {
+        InstanceBuilder instance_builder;
+        instance_builder.set_number_of_resources(2);
+        instance_builder.set_resource_capacity(0, 10);
+        instance_builder.set_resource_capacity(1, 10);
+        std::vector<std::vector<Weight>> weights = {{3, 0}, {3, 6}, {0, 1}, {4, 3}};
+        for (GroupId group_id = 0; group_id < 4; ++group_id) {
+            instance_builder.add_item(group_id, 10 + group_id);
+            instance_builder.set_weight(group_id, 0, 0, weights[group_id][0]);
+            instance_builder.set_weight(group_id, 0, 1, weights[group_id][1]);
+            instance_builder.add_item(group_id, 20);
+            instance_builder.set_weight(group_id, 1, 0, 10);
+            instance_builder.set_weight(group_id, 1, 1, 10);
+        }
+        Instance instance = instance_builder.build();
+        SurrogateRelaxationBound bound(instance);
+        std::vector<ItemId> fixed_item_ids(instance.number_of_groups(), -1);
+        ok &= check_bound(bound, instance, fixed_item_ids);
+    }
+
+    // Random instances, multipliers and fixed items.
+    std::mt19937_64 generator(0);
+    std::uniform_int_distribution<Weight> weight_distribution(0, 10);
+    std::uniform_int_distribution<Profit> profit_distribution(0, 20);
+    std::uniform_real_distribution<double> multiplier_distribution(0, 1);
+    for (int instance_pos = 0; instance_pos < 2000; ++instance_pos) {
+        ResourceId number_of_resources = 1 + generator() % 3;
+        GroupId number_of_groups = 1 + generator() % 4;
+        InstanceBuilder instance_builder;
+        instance_builder.set_number_of_resources(number_of_resources);
+        for (ResourceId resource_id = 0;
+                resource_id < number_of_resources;
+                ++resource_id) {
+            instance_builder.set_resource_capacity(
+                    resource_id,
+                    number_of_groups * 3 + generator() % 10);
+        }
+        for (GroupId group_id = 0; group_id < number_of_groups; ++group_id) {
+            ItemId number_of_items = 1 + generator() % 4;
+            for (ItemId item_id = 0; item_id < number_of_items; ++item_id) {
+                instance_builder.add_item(group_id, profit_distribution(generator));
+                for (ResourceId resource_id = 0;
+                        resource_id < number_of_resources;
+                        ++resource_id) {
+                    instance_builder.set_weight(
+                            group_id,
+                            item_id,
+                            resource_id,
+                            weight_distribution(generator));
+                }
+            }
+        }
+        Instance instance = instance_builder.build();
+        SurrogateRelaxationBound bound(instance);
+        for (int multipliers_pos = 0; multipliers_pos < 3; ++multipliers_pos) {
+            if (multipliers_pos > 0) {
+                std::vector<double> multipliers(number_of_resources);
+                for (double& multiplier: multipliers)
+                    multiplier = multiplier_distribution(generator);
+                bound.set_multipliers(multipliers);
+            }
+            std::vector<ItemId> fixed_item_ids(number_of_groups, -1);
+            ok &= check_bound(bound, instance, fixed_item_ids);
+            for (GroupId group_id = 0; group_id < number_of_groups; ++group_id) {
+                if (generator() % 2 == 0)
+                    continue;
+                fixed_item_ids[group_id] = generator() % instance.number_of_items(group_id);
+                bound.fix(group_id, fixed_item_ids[group_id]);
+                ok &= check_bound(bound, instance, fixed_item_ids);
+            }
+            for (GroupId group_id = 0; group_id < number_of_groups; ++group_id) {
+                if (fixed_item_ids[group_id] == -1)
+                    continue;
+                fixed_item_ids[group_id] = -1;
+                bound.unfix(group_id);
+                ok &= check_bound(bound, instance, fixed_item_ids);
+            }
+        }
+    }
+
+    return (ok)? 0: 1;
+}